@@ -4,6 +4,7 @@
 #include <string.h>
 #include <ctype.h>
 #include <errno.h>
+#include <limits.h>
 
 // ELF相关定义
 #define EI_NIDENT 16
@@ -57,6 +58,13 @@ typedef struct {
 #include <sys/stat.h>
 #endif
 
+// 原始文件生成对象时的默认格式取决于编译本工具的平台
+#ifdef _WIN32
+#define HOST_FORMAT FORMAT_COFF
+#else
+#define HOST_FORMAT FORMAT_ELF
+#endif
+
 typedef struct
 {
     uint16_t Machine;
@@ -86,6 +94,21 @@ typedef struct
     uint8_t NumberOfAuxSymbols;
 } COFF_SYMBOL;
 
+// COFF节头
+typedef struct
+{
+    char Name[8];
+    uint32_t VirtualSize;
+    uint32_t VirtualAddress;
+    uint32_t SizeOfRawData;
+    uint32_t PointerToRawData;
+    uint32_t PointerToRelocations;
+    uint32_t PointerToLinenumbers;
+    uint16_t NumberOfRelocations;
+    uint16_t NumberOfLinenumbers;
+    uint32_t Characteristics;
+} COFF_SECTION;
+
 typedef struct
 {
     char *name;
@@ -94,14 +117,137 @@ typedef struct
     uint8_t storageClass;
 } Symbol;
 
+// 节信息：ELF 按节索引存放，COFF 按节号减一存放
+typedef struct
+{
+    char *name;
+    uint32_t offset; // 数据在文件中的偏移
+    uint32_t size;
+    uint64_t flags;  // ELF sh_flags / COFF Characteristics
+    uint32_t align;
+    int nobits;      // 节在文件中没有数据（.bss）
+} Section;
+
+// 对象文件格式
+enum
+{
+    FORMAT_ELF = 0,
+    FORMAT_COFF
+};
+
+struct ObjectFile;
+
+// 差分模式下资源的存放方式
+enum
+{
+    DELTA_NONE = 0,
+    DELTA_RAW,  // 原样存放（基准资源或压缩无收益）
+    DELTA_LZ4,  // 独立 LZ4 压缩，不引用基准资源
+    DELTA_COPY  // 相对基准资源的复制/插入差分
+};
+
+// --short-names 的命名方式
+enum
+{
+    SHORT_NAMES_NONE = 0,
+    SHORT_NAMES_MACRO, // 使用宏名，没有宏名时退回到哈希
+    SHORT_NAMES_HASH   // 使用原符号前缀的 XXH64
+};
+
+// 资源：由同一前缀的 _start/_end/_size 符号组成，字段为符号索引，-1 表示缺失
 typedef struct
+{
+    char *base;
+    char *origBase; // --short-names 改名前的符号前缀，用于生成标识符；NULL 表示没有改名
+    int start;
+    int end;
+    int size;
+    const struct ObjectFile *aliasFile; // 去重后内容相同的规范资源，NULL 表示自身即规范资源
+    int aliasAsset;
+    uint64_t packedSize; // 压缩后的大小，0 表示没有压缩数据
+    int packedRaw;       // 压缩没有收益，.lz4.o 中原样存放（packedSize 等于原始大小）
+    int deltaKind;
+    const struct ObjectFile *deltaBaseFile; // 差分的基准资源，NULL 表示没有基准
+    int deltaBaseAsset;
+    uint64_t deltaSize; // 差分模式下实际存放的字节数
+    int rank;           // 在 --order-profile 中的位置，-1 表示没有列出
+    int64_t packOffset; // 在 --pack 资源包中的偏移，-1 表示不在包中
+} Asset;
+
+typedef struct ObjectFile
 {
     char *filepath;
+    char *inputPath; // 命令行给出的路径；改写对象后 filepath 指向新生成的对象
     char *macro;
     Symbol *symbols;
     int symbolCount;
+    Asset *assets;
+    int assetCount;
+    Section *sections;
+    int sectionCount;
+    int format;
+    uint16_t machine;
+    int stripSpirv; // 嵌入前剥离 SPIR-V 调试指令
 } ObjectFile;
 
+// 输出语言
+typedef enum
+{
+    LANG_C = 0,
+    LANG_CPP
+} OutputLang;
+
+// 合并头文件的分片方式
+typedef enum
+{
+    SHARD_NONE = 0,
+    SHARD_BY_DIR,
+    SHARD_BY_COUNT
+} ShardMode;
+
+// 命令行选项
+typedef struct
+{
+    OutputLang lang;
+    const char *cppNamespace;
+    int registry;
+    int xmacro;
+    ShardMode shardBy;
+    int shardCount;
+    int spirvAlign; // 0 表示不启用 SPIR-V 模式
+    int reflect;
+    int hash;
+    int dedup;
+    int prefetch;
+    const char *hotList; // 逗号分隔的资源名称
+    int compress;
+    int compressDict;        // 共享字典的最大字节数，0 表示不训练字典
+    char dictBase[300];      // 共享字典的符号前缀，由压缩步骤写入，空字符串表示没有字典
+    uint32_t dictSize;
+    int delta;
+    int deltaByDir;
+    int stripSpirv;
+    int rewriteRodata;        // 把输入对象中资源所在的可写节改为只读
+    int zeroBss;              // 全零的资源改为未初始化数据（.bss）
+    int shortNames;           // SHORT_NAMES_*，把输入对象中的 _binary_ 符号改为短名称
+    const char *mergeOut;     // 合并所有资源的对象文件路径，NULL 表示不合并
+    const char *pack;         // 资源包文件路径，NULL 表示不生成
+    int lazy;                 // 生成第一次访问时解析到资源包或嵌入符号的访问器
+    uint32_t chunkSize;       // 分块表中每块的字节数，0 表示不生成分块表
+    uint64_t chunkThreshold;  // 大于该字节数的资源才生成分块表
+    int linkerScript;         // 生成链接脚本片段
+    int linkerOrder;          // LINKER_ORDER_*
+    const char *orderProfile; // 运行时记录的资源首次访问顺序，每行一个资源名
+    uint32_t realign;         // 提高输入对象中资源所在节的对齐，0 表示不修改
+    int sectionPerAsset;      // 生成对象时每个资源单独一节
+    int rawFormat;            // 原始文件生成对象的格式
+    uint32_t assetAlign;      // 生成对象中资源的对齐
+    const char *assetSection; // 生成对象的节名，NULL 表示 .rodata/.rdata
+    int deterministic;
+    const char **prefixMaps; // "OLD=NEW"，指向命令行参数
+    int prefixMapCount;
+} Options;
+
 static void free_symbols(Symbol *syms, int count)
 {
     for (int i = 0; i < count; i++)
@@ -111,6 +257,25 @@ static void free_symbols(Symbol *syms, int count)
     free(syms);
 }
 
+static void free_assets(Asset *assets, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        free(assets[i].base);
+        free(assets[i].origBase);
+    }
+    free(assets);
+}
+
+static void free_sections(Section *sections, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        free(sections[i].name);
+    }
+    free(sections);
+}
+
 static char *my_strdup(const char *s)
 {
     size_t len = strlen(s) + 1;
@@ -121,10 +286,10 @@ static char *my_strdup(const char *s)
 }
 
 // 解析COFF格式对象文件
-static int parse_coff(const char *filename, Symbol **outSymbols, int *outCount);
+static int parse_coff(const char *filename, ObjectFile *file);
 
 // 解析ELF格式对象文件
-static int parse_elf(const char *filename, Symbol **outSymbols, int *outCount)
+static int parse_elf(const char *filename, ObjectFile *file)
 {
     FILE *f = fopen(filename, "rb");
     if (!f)
@@ -224,6 +389,27 @@ static int parse_elf(const char *filename, Symbol **outSymbols, int *outCount)
         return 0;
     }
 
+    // 记录节信息，供读取资源数据使用
+    Section *sections = calloc(ehdr.e_shnum ? ehdr.e_shnum : 1, sizeof(Section));
+    if (!sections)
+    {
+        fprintf(stderr, "Memory allocation failed for sections\n");
+        free(shstrtab);
+        free(shdrs);
+        fclose(f);
+        return 0;
+    }
+    for (int i = 0; i < ehdr.e_shnum; i++)
+    {
+        const char *name = shdrs[i].sh_name < shdrs[ehdr.e_shstrndx].sh_size ? shstrtab + shdrs[i].sh_name : "";
+        sections[i].name = my_strdup(name);
+        sections[i].offset = (uint32_t)shdrs[i].sh_offset;
+        sections[i].size = (uint32_t)shdrs[i].sh_size;
+        sections[i].flags = shdrs[i].sh_flags;
+        sections[i].align = (uint32_t)shdrs[i].sh_addralign;
+        sections[i].nobits = shdrs[i].sh_type == 8; // SHT_NOBITS
+    }
+
     // 查找符号表（.symtab）和对应的字符串表（.strtab）
     Elf64_Shdr *symtab_shdr = NULL;
     Elf64_Shdr *strtab_shdr = NULL;
@@ -244,6 +430,7 @@ static int parse_elf(const char *filename, Symbol **outSymbols, int *outCount)
     if (!symtab_shdr || !strtab_shdr)
     {
         fprintf(stderr, "Symbol table or string table not found in '%s'\n", filename);
+        free_sections(sections, ehdr.e_shnum);
         free(shstrtab);
         free(shdrs);
         fclose(f);
@@ -255,6 +442,7 @@ static int parse_elf(const char *filename, Symbol **outSymbols, int *outCount)
     if (!strtab)
     {
         fprintf(stderr, "Memory allocation failed for string table\n");
+        free_sections(sections, ehdr.e_shnum);
         free(shstrtab);
         free(shdrs);
         fclose(f);
@@ -266,6 +454,7 @@ static int parse_elf(const char *filename, Symbol **outSymbols, int *outCount)
     {
         fprintf(stderr, "Error reading string table from '%s'\n", filename);
         free(strtab);
+        free_sections(sections, ehdr.e_shnum);
         free(shstrtab);
         free(shdrs);
         fclose(f);
@@ -281,6 +470,7 @@ static int parse_elf(const char *filename, Symbol **outSymbols, int *outCount)
     {
         fprintf(stderr, "Memory allocation failed for symbols\n");
         free(strtab);
+        free_sections(sections, ehdr.e_shnum);
         free(shstrtab);
         free(shdrs);
         fclose(f);
@@ -329,13 +519,17 @@ static int parse_elf(const char *filename, Symbol **outSymbols, int *outCount)
     free(shdrs);
     fclose(f);
 
-    *outSymbols = symbols;
-    *outCount = symCount;
+    file->symbols = symbols;
+    file->symbolCount = symCount;
+    file->sections = sections;
+    file->sectionCount = ehdr.e_shnum;
+    file->format = FORMAT_ELF;
+    file->machine = ehdr.e_machine;
     return 1;
 }
 
 // 解析对象文件（自动检测格式）
-static int parse_object_file(const char *filename, Symbol **outSymbols, int *outCount)
+static int parse_object_file(const char *filename, ObjectFile *file)
 {
     FILE *f = fopen(filename, "rb");
     if (!f)
@@ -358,18 +552,18 @@ static int parse_object_file(const char *filename, Symbol **outSymbols, int *out
     if (magic[0] == 0x7F && magic[1] == 'E' && magic[2] == 'L' && magic[3] == 'F')
     {
         // ELF格式
-        return parse_elf(filename, outSymbols, outCount);
+        return parse_elf(filename, file);
     }
     else
     {
         // 假设是COFF格式
         // 重命名原来的parse_coff函数为parse_coff_internal，然后调用它
-        return parse_coff(filename, outSymbols, outCount);
+        return parse_coff(filename, file);
     }
 }
 
 // 原来的parse_coff函数，现在只处理COFF格式
-static int parse_coff(const char *filename, Symbol **outSymbols, int *outCount)
+static int parse_coff(const char *filename, ObjectFile *file)
 {
     FILE *f = fopen(filename, "rb");
     if (!f)
@@ -475,11 +669,54 @@ static int parse_coff(const char *filename, Symbol **outSymbols, int *outCount)
         }
     }
 
+    // 读取节头，记录节信息供读取资源数据使用
+    Section *sections = calloc(hdr.NumberOfSections ? hdr.NumberOfSections : 1, sizeof(Section));
+    if (!sections)
+    {
+        fprintf(stderr, "Memory allocation failed for sections\n");
+        free(strTable);
+        fclose(f);
+        return 0;
+    }
+    fseek(f, sizeof(COFF_HEADER) + hdr.SizeOfOptionalHeader, SEEK_SET);
+    for (int s = 0; s < hdr.NumberOfSections; s++)
+    {
+        COFF_SECTION sec;
+        if (fread(&sec, sizeof(sec), 1, f) != 1)
+        {
+            fprintf(stderr, "Error reading section header %d from '%s'\n", s, filename);
+            free_sections(sections, hdr.NumberOfSections);
+            free(strTable);
+            fclose(f);
+            return 0;
+        }
+
+        char secName[256];
+        memcpy(secName, sec.Name, 8);
+        secName[8] = '\0';
+        // 长节名以 "/偏移" 的形式引用字符串表
+        if (secName[0] == '/' && strTable)
+        {
+            uint32_t offset = (uint32_t)atoi(secName + 1);
+            if (offset < strTableSize)
+                snprintf(secName, sizeof(secName), "%s", strTable + offset);
+        }
+
+        uint32_t alignBits = (sec.Characteristics >> 20) & 0xF;
+        sections[s].name = my_strdup(secName);
+        sections[s].offset = sec.PointerToRawData;
+        sections[s].size = sec.SizeOfRawData;
+        sections[s].flags = sec.Characteristics;
+        sections[s].align = alignBits ? 1u << (alignBits - 1) : 16; // 未指定时默认 16 字节
+        sections[s].nobits = (sec.Characteristics & 0x80) != 0 || sec.PointerToRawData == 0; // IMAGE_SCN_CNT_UNINITIALIZED_DATA
+    }
+
     // 分配符号数组
     Symbol *symbols = malloc(hdr.NumberOfSymbols * sizeof(Symbol));
     if (!symbols)
     {
         fprintf(stderr, "Memory allocation failed for symbols\n");
+        free_sections(sections, hdr.NumberOfSections);
         free(strTable);
         fclose(f);
         return 0;
@@ -550,8 +787,12 @@ static int parse_coff(const char *filename, Symbol **outSymbols, int *outCount)
     free(strTable);
     fclose(f);
 
-    *outSymbols = symbols;
-    *outCount = symCount;
+    file->symbols = symbols;
+    file->symbolCount = symCount;
+    file->sections = sections;
+    file->sectionCount = hdr.NumberOfSections;
+    file->format = FORMAT_COFF;
+    file->machine = hdr.Machine;
     return 1;
 }
 
@@ -588,6 +829,44 @@ static void normalize_path(char *out, size_t outSize, const char *path)
     }
 }
 
+// 判断规范化后的路径是否为绝对路径（/xxx 或 C:/xxx）
+static int path_is_absolute(const char *path)
+{
+    return path[0] == '/' || (isalpha((unsigned char)path[0]) && path[1] == ':');
+}
+
+// 生成写入注释的路径：按 --prefix-map 重映射前缀（后指定的优先），
+// 确定性模式下仍为绝对路径的只保留文件名，保证输出与检出位置无关
+static void display_path(char *out, size_t outSize, const char *filepath, const Options *opts)
+{
+    char normalized[1024];
+    normalize_path(normalized, sizeof(normalized), filepath);
+
+    for (int m = opts->prefixMapCount - 1; m >= 0; m--)
+    {
+        const char *map = opts->prefixMaps[m];
+        const char *eq = strchr(map, '=');
+        char oldPrefix[1024];
+        snprintf(oldPrefix, sizeof(oldPrefix), "%.*s", (int)(eq - map), map);
+        normalize_path(oldPrefix, sizeof(oldPrefix), oldPrefix);
+        size_t oldLen = strlen(oldPrefix);
+        if (oldLen > 0 && strncmp(normalized, oldPrefix, oldLen) == 0 &&
+            (normalized[oldLen] == '\0' || normalized[oldLen] == '/'))
+        {
+            snprintf(out, outSize, "%s%s", eq + 1, normalized + oldLen);
+            return;
+        }
+    }
+
+    if (opts->deterministic && path_is_absolute(normalized))
+    {
+        const char *slash = strrchr(normalized, '/');
+        snprintf(out, outSize, "%s", slash ? slash + 1 : normalized);
+        return;
+    }
+    snprintf(out, outSize, "%s", normalized);
+}
+
 // 将字符串转换为大写
 static void to_uppercase(char *str)
 {
@@ -597,238 +876,5788 @@ static void to_uppercase(char *str)
     }
 }
 
-static void generate_header(const char *outDir, const char *baseName, const char *macro, Symbol *symbols, int count)
+// 将字符串转换为小写
+static void to_lowercase(char *str)
 {
-    char headerPath[1024];
-    char normalizedDir[1024];
-    
-    // 规范化输出目录
-    normalize_path(normalizedDir, sizeof(normalizedDir), outDir);
-    
-    // 统一使用正斜杠拼接路径
-    snprintf(headerPath, sizeof(headerPath), "%s/%s.h", normalizedDir, baseName);
-
-    FILE *h = fopen(headerPath, "w");
-    if (!h)
+    for (char *p = str; *p; p++)
     {
-        fprintf(stderr, "Error creating header file '%s': %s\n", headerPath, strerror(errno));
-        return;
+        *p = tolower((unsigned char)*p);
     }
+}
 
-    // 创建清理后的宏名称（将点号替换为下划线）
-    char cleanName[256];
-    strncpy(cleanName, baseName, sizeof(cleanName) - 1);
-    cleanName[sizeof(cleanName) - 1] = '\0';
-    for (char *p = cleanName; *p; p++)
-    {
-        if (*p == '.')
-            *p = '_';
-    }
-    
-    // 转换为大写
-    to_uppercase(cleanName);
+// 判断符号是否为绝对符号（COFF: IMAGE_SYM_ABSOLUTE = -1，ELF: SHN_ABS = 0xfff1）
+static int symbol_is_absolute(const Symbol *sym)
+{
+    return sym->section == -1 || sym->section == (int16_t)0xfff1;
+}
 
-    fprintf(h, "// Auto-generated header from %s.o\n", baseName);
-    fprintf(h, "#ifndef _INCLUDE_%s_H_\n", cleanName);
-    fprintf(h, "#define _INCLUDE_%s_H_\n\n", cleanName);
+// 符号后缀类别
+enum
+{
+    SUFFIX_NONE = 0,
+    SUFFIX_START,
+    SUFFIX_END,
+    SUFFIX_SIZE
+};
 
-    for (int i = 0; i < count; i++)
+// 识别符号名称的后缀，返回类别并输出后缀长度
+static int symbol_suffix(const char *name, size_t *suffixLen)
+{
+    static const struct
     {
-        const char *name = symbols[i].name;
-        // 根据后缀确定类型
-        if (strstr(name, "_size"))
-        {
-            fprintf(h, "extern const unsigned int %s;\n", name);
-        }
-        else if (strstr(name, "_start") || strstr(name, "_end"))
-        {
-            fprintf(h, "extern const unsigned char %s[];\n", name);
-        }
-        else
+        const char *text;
+        int kind;
+    } suffixes[] = {
+        {"_start", SUFFIX_START},
+        {"_end", SUFFIX_END},
+        {"_size", SUFFIX_SIZE},
+    };
+
+    size_t len = strlen(name);
+    for (size_t i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); i++)
+    {
+        size_t n = strlen(suffixes[i].text);
+        if (len > n && strcmp(name + len - n, suffixes[i].text) == 0)
         {
-            fprintf(h, "extern const unsigned char %s[];\n", name);
+            *suffixLen = n;
+            return suffixes[i].kind;
         }
     }
+    *suffixLen = 0;
+    return SUFFIX_NONE;
+}
 
-    if (macro && macro[0])
+// 按符号前缀把 _start/_end/_size 归组为资源
+static int collect_assets(ObjectFile *file)
+{
+    file->assets = malloc((file->symbolCount > 0 ? file->symbolCount : 1) * sizeof(Asset));
+    file->assetCount = 0;
+    if (!file->assets)
     {
-        fprintf(h, "\n// Macros for convenience\n");
-        for (int i = 0; i < count; i++)
+        fprintf(stderr, "Memory allocation failed for assets\n");
+        return 0;
+    }
+
+    for (int i = 0; i < file->symbolCount; i++)
+    {
+        const char *name = file->symbols[i].name;
+        size_t suffixLen;
+        int kind = symbol_suffix(name, &suffixLen);
+        if (kind == SUFFIX_NONE)
+            continue;
+
+        size_t baseLen = strlen(name) - suffixLen;
+        Asset *asset = NULL;
+        for (int a = 0; a < file->assetCount; a++)
         {
-            const char *name = symbols[i].name;
-            // 提取后缀
-            const char *suffix = strrchr(name, '_');
-            if (suffix)
+            if (strlen(file->assets[a].base) == baseLen && strncmp(file->assets[a].base, name, baseLen) == 0)
             {
-                suffix++; // 跳过下划线
-                char macroName[256];
-                snprintf(macroName, sizeof(macroName), "%s_%s", macro, suffix);
-                // 将宏名称转换为大写
-                to_uppercase(macroName);
-                fprintf(h, "#define %s %s\n", macroName, name);
+                asset = &file->assets[a];
+                break;
             }
         }
-    }
 
-    fprintf(h, "\n#endif // _INCLUDE_%s_H_\n", cleanName);
-    fclose(h);
-    printf("Generated header: %s\n", headerPath);
+        if (!asset)
+        {
+            asset = &file->assets[file->assetCount];
+            asset->base = malloc(baseLen + 1);
+            if (!asset->base)
+            {
+                fprintf(stderr, "Memory allocation failed for assets\n");
+                return 0;
+            }
+            memcpy(asset->base, name, baseLen);
+            asset->base[baseLen] = '\0';
+            asset->origBase = NULL;
+            asset->start = asset->end = asset->size = -1;
+            asset->aliasFile = NULL;
+            asset->aliasAsset = -1;
+            asset->packedSize = 0;
+            asset->packedRaw = 0;
+            asset->deltaKind = DELTA_NONE;
+            asset->deltaBaseFile = NULL;
+            asset->deltaBaseAsset = -1;
+            asset->deltaSize = 0;
+            asset->rank = -1;
+            asset->packOffset = -1;
+            file->assetCount++;
+        }
+
+        if (kind == SUFFIX_START)
+            asset->start = i;
+        else if (kind == SUFFIX_END)
+            asset->end = i;
+        else
+            asset->size = i;
+    }
+    return 1;
 }
 
-static void generate_combined_header(const char *outDir, const char *headerName, ObjectFile *files, int fileCount)
+// 计算资源大小：优先使用同节内 _end - _start，否则使用绝对符号 _size 的值
+static int asset_size(const ObjectFile *file, const Asset *asset, uint64_t *outSize)
 {
-    char headerPath[1024];
-    char normalizedDir[1024];
-    
-    // 规范化输出目录
-    normalize_path(normalizedDir, sizeof(normalizedDir), outDir);
-    
-    // 检查headerName是否已经以.h结尾
-    size_t nameLen = strlen(headerName);
-    int hasExtension = (nameLen >= 2 && strcmp(headerName + nameLen - 2, ".h") == 0);
-    
-    // 统一使用正斜杠拼接路径
-    if (hasExtension)
+    if (asset->start >= 0 && asset->end >= 0)
     {
-        snprintf(headerPath, sizeof(headerPath), "%s/%s", normalizedDir, headerName);
+        const Symbol *s = &file->symbols[asset->start];
+        const Symbol *e = &file->symbols[asset->end];
+        if (s->section == e->section && !symbol_is_absolute(s) && e->value >= s->value)
+        {
+            *outSize = e->value - s->value;
+            return 1;
+        }
     }
-    else
+    if (asset->size >= 0 && symbol_is_absolute(&file->symbols[asset->size]))
     {
-        snprintf(headerPath, sizeof(headerPath), "%s/%s.h", normalizedDir, headerName);
+        *outSize = file->symbols[asset->size].value;
+        return 1;
     }
+    return 0;
+}
 
-    FILE *h = fopen(headerPath, "w");
-    if (!h)
-    {
-        fprintf(stderr, "Error creating header file '%s': %s\n", headerPath, strerror(errno));
-        return;
-    }
+// 取符号所在的节，绝对符号或未定义符号返回 NULL
+static const Section *symbol_section(const ObjectFile *file, const Symbol *sym)
+{
+    if (symbol_is_absolute(sym) || sym->section == 0)
+        return NULL;
+    int index = file->format == FORMAT_COFF ? sym->section - 1 : (uint16_t)sym->section;
+    if (index < 0 || index >= file->sectionCount)
+        return NULL;
+    return &file->sections[index];
+}
 
-    // 清理头文件名用于宏定义
-    char cleanName[256];
-    strncpy(cleanName, headerName, sizeof(cleanName) - 1);
-    cleanName[sizeof(cleanName) - 1] = '\0';
-    for (char *p = cleanName; *p; p++)
-    {
-        if (*p == '.')
-            *p = '_';
-    }
-    
-    // 转换为大写
-    to_uppercase(cleanName);
+// 定位到文件的 64 位偏移：Windows（LLP64，long 为 32 位）使用 _fseeki64，其他平台的 long 为 64 位；
+// 偏移超出 long 的范围时失败而不是截断
+static int seek_file(FILE *f, uint64_t offset)
+{
+#ifdef _WIN32
+    return offset <= (uint64_t)INT64_MAX && _fseeki64(f, (__int64)offset, SEEK_SET) == 0;
+#else
+    return offset <= (uint64_t)LONG_MAX && fseek(f, (long)offset, SEEK_SET) == 0;
+#endif
+}
 
-    fprintf(h, "// Auto-generated combined header from %d object files\n", fileCount);
-    fprintf(h, "#ifndef _INCLUDE_%s_H_\n", cleanName);
-    fprintf(h, "#define _INCLUDE_%s_H_\n\n", cleanName);
+// 读取资源数据（_start 到 _end 之间的字节），成功时返回 malloc 分配的缓冲区
+static int read_asset_payload(const ObjectFile *file, const Asset *asset, unsigned char **outData, size_t *outSize)
+{
+    uint64_t size;
+    if (asset->start < 0 || !asset_size(file, asset, &size))
+        return 0;
 
-    // 收集所有符号
-    int totalSymbols = 0;
-    for (int f = 0; f < fileCount; f++)
+    const Symbol *start = &file->symbols[asset->start];
+    const Section *sec = symbol_section(file, start);
+    if (!sec || (uint64_t)start->value + size > sec->size)
     {
-        totalSymbols += files[f].symbolCount;
+        fprintf(stderr, "Payload of '%s' is not inside a section of '%s'\n", asset->base, file->filepath);
+        return 0;
     }
 
-    // 输出所有符号
-    for (int f = 0; f < fileCount; f++)
+    unsigned char *data = calloc(size ? size : 1, 1);
+    if (!data)
     {
-        if (files[f].symbolCount > 0)
-        {
-            // 规范化文件路径用于输出
-            char normalizedFilePath[1024];
-            normalize_path(normalizedFilePath, sizeof(normalizedFilePath), files[f].filepath);
-            fprintf(h, "// From %s\n", normalizedFilePath);
-            for (int i = 0; i < files[f].symbolCount; i++)
-            {
-                const char *name = files[f].symbols[i].name;
-                if (strstr(name, "_size"))
-                {
-                    fprintf(h, "extern const unsigned int %s;\n", name);
-                }
-                else if (strstr(name, "_start") || strstr(name, "_end"))
-                {
-                    fprintf(h, "extern const unsigned char %s[];\n", name);
-                }
-                else
-                {
-                    fprintf(h, "extern const unsigned char %s[];\n", name);
-                }
-            }
-            fprintf(h, "\n");
-        }
+        fprintf(stderr, "Memory allocation failed for payload of '%s'\n", asset->base);
+        return 0;
     }
 
-    // 输出宏定义（如果有）
-    int hasMacros = 0;
-    for (int f = 0; f < fileCount; f++)
+    // 无数据的节（.bss）内容全部为零
+    if (!sec->nobits && size > 0)
     {
-        if (files[f].macro && files[f].macro[0])
+        FILE *f = fopen(file->filepath, "rb");
+        if (!f)
         {
-            hasMacros = 1;
-            break;
+            fprintf(stderr, "Error opening file '%s': %s\n", file->filepath, strerror(errno));
+            free(data);
+            return 0;
         }
-    }
-    if (hasMacros)
-    {
-        fprintf(h, "// Macros for convenience\n");
-        for (int f = 0; f < fileCount; f++)
+        if (!seek_file(f, (uint64_t)sec->offset + start->value) || fread(data, 1, size, f) != size)
         {
-            if (files[f].macro && files[f].macro[0] && files[f].symbolCount > 0)
-            {
-                // 规范化文件路径用于输出
-                char normalizedFilePath[1024];
-                normalize_path(normalizedFilePath, sizeof(normalizedFilePath), files[f].filepath);
-                fprintf(h, "// From %s\n", normalizedFilePath);
-                for (int i = 0; i < files[f].symbolCount; i++)
-                {
-                    const char *name = files[f].symbols[i].name;
-                    const char *suffix = strrchr(name, '_');
-                    if (suffix)
-                    {
-                        suffix++;
-                        char macroName[256];
-                        snprintf(macroName, sizeof(macroName), "%s_%s", files[f].macro, suffix);
-                        // 将宏名称转换为大写
-                        to_uppercase(macroName);
-                        fprintf(h, "#define %s %s\n", macroName, name);
-                    }
-                }
-            }
+            fprintf(stderr, "Error reading payload of '%s' from '%s'\n", asset->base, file->filepath);
+            free(data);
+            fclose(f);
+            return 0;
         }
+        fclose(f);
     }
 
-    fprintf(h, "\n#endif // _INCLUDE_%s_H_\n", cleanName);
-    fclose(h);
-    printf("Generated combined header: %s\n", headerPath);
+    *outData = data;
+    *outSize = (size_t)size;
+    return 1;
 }
 
-static char *basename(const char *path)
+// XXH64 哈希：四条独立累加通道并行处理 32 字节块，编译器可以将其向量化；结果与标准 XXH64 一致
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3 0x165667B19E3779F9ULL
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ULL
+
+static uint64_t read_le64(const unsigned char *p)
 {
-    const char *slash = strrchr(path, '/');
-    if (!slash)
-        slash = strrchr(path, '\\');
-    const char *start = slash ? slash + 1 : path;
-    char *base = my_strdup(start);
-    // 移除扩展名 .o
-    char *dot = strrchr(base, '.');
-    if (dot && (strcmp(dot, ".o") == 0 || strcmp(dot, ".obj") == 0))
-    {
-        *dot = '\0';
-    }
-    return base;
+    return (uint64_t)p[0] | ((uint64_t)p[1] << 8) | ((uint64_t)p[2] << 16) | ((uint64_t)p[3] << 24) |
+           ((uint64_t)p[4] << 32) | ((uint64_t)p[5] << 40) | ((uint64_t)p[6] << 48) | ((uint64_t)p[7] << 56);
 }
 
-int main(int argc, char **argv)
+static uint32_t read_le32(const unsigned char *p)
 {
-    if (argc < 3)
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t xxh64_round(uint64_t acc, uint64_t input)
+{
+    acc += input * XXH_PRIME64_2;
+    acc = rotl64(acc, 31);
+    return acc * XXH_PRIME64_1;
+}
+
+static uint64_t xxh64_merge(uint64_t acc, uint64_t val)
+{
+    acc ^= xxh64_round(0, val);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+static uint64_t xxh64(const void *input, size_t len, uint64_t seed)
+{
+    const unsigned char *p = input;
+    const unsigned char *end = p + len;
+    uint64_t h;
+
+    if (len >= 32)
+    {
+        uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+        uint64_t v2 = seed + XXH_PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_PRIME64_1;
+        const unsigned char *limit = end - 32;
+        do
+        {
+            v1 = xxh64_round(v1, read_le64(p));
+            v2 = xxh64_round(v2, read_le64(p + 8));
+            v3 = xxh64_round(v3, read_le64(p + 16));
+            v4 = xxh64_round(v4, read_le64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxh64_merge(h, v1);
+        h = xxh64_merge(h, v2);
+        h = xxh64_merge(h, v3);
+        h = xxh64_merge(h, v4);
+    }
+    else
+    {
+        h = seed + XXH_PRIME64_5;
+    }
+
+    h += (uint64_t)len;
+    while (p + 8 <= end)
+    {
+        h ^= xxh64_round(0, read_le64(p));
+        h = rotl64(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+        p += 8;
+    }
+    if (p + 4 <= end)
+    {
+        h ^= (uint64_t)read_le32(p) * XXH_PRIME64_1;
+        h = rotl64(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        p += 4;
+    }
+    while (p < end)
+    {
+        h ^= (*p) * XXH_PRIME64_5;
+        h = rotl64(h, 11) * XXH_PRIME64_1;
+        p++;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+// 判断数据是否全为零：每次把 64 字节按 8 个 64 位字按位或到独立的累加器（编译器可以将其向量化），
+// 每块结束时检查一次，遇到非零块立即返回
+static int is_all_zero(const unsigned char *p, size_t len)
+{
+    const unsigned char *end = p + len;
+    while (p + 64 <= end)
+    {
+        uint64_t acc[8] = {0};
+        for (int k = 0; k < 8; k++)
+            acc[k] |= read_le64(p + k * 8);
+        if ((acc[0] | acc[1] | acc[2] | acc[3] | acc[4] | acc[5] | acc[6] | acc[7]) != 0)
+            return 0;
+        p += 64;
+    }
+    unsigned char tail = 0;
+    while (p < end)
+        tail |= *p++;
+    return tail == 0;
+}
+
+// 去重后的资源引用规范资源的符号，返回实际应引用的资源并更新所在文件
+static const Asset *canonical_asset(const ObjectFile **file, const Asset *asset)
+{
+    if (asset->aliasFile)
+    {
+        *file = asset->aliasFile;
+        return &asset->aliasFile->assets[asset->aliasAsset];
+    }
+    return asset;
+}
+
+// 返回生成代码中引用某个符号时应使用的名称：重复资源的符号替换为规范资源中同后缀的符号
+static const char *symbol_reference(const ObjectFile *file, int index)
+{
+    for (int a = 0; a < file->assetCount; a++)
+    {
+        const Asset *asset = &file->assets[a];
+        if (!asset->aliasFile || (asset->start != index && asset->end != index && asset->size != index))
+            continue;
+
+        const ObjectFile *target = file;
+        const Asset *canon = canonical_asset(&target, asset);
+        int mapped = asset->start == index ? canon->start : asset->end == index ? canon->end : canon->size;
+        if (mapped >= 0)
+            return target->symbols[mapped].name;
+    }
+    return file->symbols[index].name;
+}
+
+// 生成资源的标识符：文件只有一个资源时使用宏名，否则使用去掉 _binary_ 前缀的符号名（改名前的名称）
+static void asset_ident(const ObjectFile *file, int index, char *out, size_t outSize)
+{
+    const char *base = file->assets[index].origBase ? file->assets[index].origBase : file->assets[index].base;
+    if (strncmp(base, "_binary_", 8) == 0)
+        base += 8;
+
+    if (file->macro && file->macro[0])
+    {
+        if (file->assetCount == 1)
+            snprintf(out, outSize, "%s", file->macro);
+        else
+            snprintf(out, outSize, "%s_%s", file->macro, base);
+    }
+    else
+    {
+        snprintf(out, outSize, "%s", base);
+    }
+}
+
+// C++ 模式下 _start 能否声明为定长数组（SPIR-V 模式下还要求大小为 4 的倍数）
+static int cpp_fixed_size(const ObjectFile *file, const Asset *asset, const Options *opts, uint64_t *outSize)
+{
+    if (opts->lang != LANG_CPP || !asset_size(file, asset, outSize) || *outSize == 0)
+        return 0;
+    return !opts->spirvAlign || *outSize % 4 == 0;
+}
+
+// 输出符号声明；C++ 模式下已知大小的 _start 声明为定长数组，便于 std::span 使用静态长度；
+// SPIR-V 模式下 _start/_end 声明为按指定对齐的 uint32_t 数组
+static void write_symbol_declaration(FILE *h, const ObjectFile *file, int i, const Options *opts)
+{
+    const char *name = file->symbols[i].name;
+    size_t suffixLen;
+    int kind = symbol_suffix(name, &suffixLen);
+    if (kind == SUFFIX_SIZE)
+    {
+        fprintf(h, "extern const unsigned int %s;\n", name);
+        return;
+    }
+
+    uint64_t size;
+    int known = 0;
+    if (kind == SUFFIX_START)
+    {
+        for (int a = 0; a < file->assetCount; a++)
+        {
+            if (file->assets[a].start == i)
+            {
+                known = cpp_fixed_size(file, &file->assets[a], opts, &size);
+                break;
+            }
+        }
+    }
+
+    if (opts->spirvAlign && kind != SUFFIX_NONE)
+    {
+        if (kind == SUFFIX_START)
+            fprintf(h, "extern SG_ALIGNED(%d) const uint32_t %s", opts->spirvAlign, name);
+        else
+            fprintf(h, "extern const uint32_t %s", name);
+        if (known)
+            fprintf(h, "[%llu];\n", (unsigned long long)(size / 4));
+        else
+            fprintf(h, "[];\n");
+    }
+    else if (known)
+        fprintf(h, "extern const unsigned char %s[%llu];\n", name, (unsigned long long)size);
+    else
+        fprintf(h, "extern const unsigned char %s[];\n", name);
+}
+
+static void write_declarations(FILE *h, const ObjectFile *file, const Options *opts)
+{
+    for (int i = 0; i < file->symbolCount; i++)
+        write_symbol_declaration(h, file, i, opts);
+}
+
+// 判断文件是否属于当前头文件的文件集合（分片时 files 是原数组中部分元素的副本，按路径比较）
+static int file_in_set(const ObjectFile *file, const ObjectFile *files, int fileCount)
+{
+    for (int f = 0; f < fileCount; f++)
+    {
+        if (&files[f] == file || strcmp(files[f].filepath, file->filepath) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+// 输出重复资源引用的、声明在当前头文件之外的规范资源符号：分片时规范资源可能位于另一个分片中，
+// 不声明的话单独包含该分片无法编译
+static void write_external_canonical_declarations(FILE *h, const ObjectFile *files, int fileCount,
+                                                  const Options *opts)
+{
+    int printed = 0;
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            const Asset *asset = &files[f].assets[a];
+            if (!asset->aliasFile || file_in_set(asset->aliasFile, files, fileCount))
+                continue;
+
+            // 同一个规范资源只声明一次
+            int seen = 0;
+            for (int g = 0; g <= f && !seen; g++)
+            {
+                for (int b = 0; b < (g == f ? a : files[g].assetCount) && !seen; b++)
+                {
+                    seen = files[g].assets[b].aliasFile == asset->aliasFile &&
+                           files[g].assets[b].aliasAsset == asset->aliasAsset;
+                }
+            }
+            if (seen)
+                continue;
+
+            if (!printed)
+                fprintf(h, "// Canonical payloads declared in other headers\n");
+            printed = 1;
+            const Asset *canon = &asset->aliasFile->assets[asset->aliasAsset];
+            if (canon->start >= 0)
+                write_symbol_declaration(h, asset->aliasFile, canon->start, opts);
+            if (canon->end >= 0)
+                write_symbol_declaration(h, asset->aliasFile, canon->end, opts);
+            if (canon->size >= 0)
+                write_symbol_declaration(h, asset->aliasFile, canon->size, opts);
+        }
+    }
+    if (printed)
+        fprintf(h, "\n");
+}
+
+// SPIR-V 模式的头文件前导：uint32_t 声明与对齐宏
+static void write_spirv_prologue(FILE *h)
+{
+    fprintf(h, "#include <stddef.h>\n");
+    fprintf(h, "#include <stdint.h>\n\n");
+    fprintf(h, "#ifndef SG_ALIGNED\n");
+    fprintf(h, "#if defined(_MSC_VER)\n");
+    fprintf(h, "#define SG_ALIGNED(n) __declspec(align(n))\n");
+    fprintf(h, "#else\n");
+    fprintf(h, "#define SG_ALIGNED(n) __attribute__((aligned(n)))\n");
+    fprintf(h, "#endif\n");
+    fprintf(h, "#endif\n\n");
+}
+
+// SPIR-V 模式下 _start 声明为按 spirvAlign 对齐的 uint32_t 数组，这个对齐必须由对象文件保证：
+// 资源所在节的对齐不小于它，且资源在节内的偏移是它的倍数，否则链接后的地址可能不对齐，按 uint32_t 访问是未定义行为
+static int check_spirv_alignment(const ObjectFile *files, int fileCount, const Options *opts)
+{
+    int ok = 1;
+    for (int f = 0; f < fileCount; f++)
+    {
+        const ObjectFile *file = &files[f];
+        for (int a = 0; a < file->assetCount; a++)
+        {
+            const Asset *asset = &file->assets[a];
+            if (asset->start < 0)
+                continue;
+            const Symbol *start = &file->symbols[asset->start];
+            const Section *sec = symbol_section(file, start);
+            if (!sec)
+            {
+                fprintf(stderr, "'%s' in '%s' is not inside a section, cannot guarantee %d-byte alignment\n",
+                        start->name, file->filepath, opts->spirvAlign);
+                ok = 0;
+            }
+            else if (start->value % opts->spirvAlign != 0)
+            {
+                fprintf(stderr, "'%s' in '%s' is at section offset %u, not a multiple of %d\n", start->name,
+                        file->filepath, start->value, opts->spirvAlign);
+                ok = 0;
+            }
+            else if (sec->align < (uint32_t)opts->spirvAlign)
+            {
+                fprintf(stderr, "'%s' in '%s' is in section '%s' aligned to %u bytes, less than %d; "
+                        "pass --realign=%d to patch the object\n",
+                        start->name, file->filepath, sec->name, sec->align, opts->spirvAlign, opts->spirvAlign);
+                ok = 0;
+            }
+        }
+    }
+    return ok;
+}
+
+// 输出 SPIR-V 着色器宏：uint32_t 代码指针、字节大小以及与 VkShaderModuleCreateInfo 兼容的初始化器
+static void write_spirv_macros(FILE *h, const ObjectFile *files, int fileCount, const Options *opts)
+{
+    fprintf(h, "\n// SPIR-V views (aligned to %d bytes) and VkShaderModuleCreateInfo initializers\n", opts->spirvAlign);
+    for (int f = 0; f < fileCount; f++)
+    {
+        const ObjectFile *file = &files[f];
+        for (int a = 0; a < file->assetCount; a++)
+        {
+            const Asset *asset = &file->assets[a];
+            if (asset->start < 0)
+                continue;
+
+            char ident[256];
+            asset_ident(file, a, ident, sizeof(ident));
+            to_uppercase(ident);
+            const ObjectFile *target = file;
+            const Asset *canon = canonical_asset(&target, asset);
+            const Symbol *start = &target->symbols[canon->start];
+
+            uint64_t size;
+            if (asset_size(file, asset, &size))
+            {
+                if (size % 4 != 0)
+                    fprintf(stderr, "Warning: '%s' is %llu bytes, not a whole number of SPIR-V words\n",
+                            asset->base, (unsigned long long)size);
+                fprintf(h, "#define %s_CODE_SIZE ((size_t)%llu)\n", ident, (unsigned long long)size);
+            }
+            else if (asset->end >= 0)
+            {
+                fprintf(h, "#define %s_CODE_SIZE ((size_t)((const unsigned char *)%s - (const unsigned char *)%s))\n",
+                        ident, target->symbols[canon->end].name, start->name);
+            }
+            else
+            {
+                continue;
+            }
+            fprintf(h, "#define %s_CODE ((const uint32_t *)%s)\n", ident, start->name);
+            fprintf(h, "#define %s_CREATE_INFO {VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, NULL, 0, %s_CODE_SIZE, %s_CODE}\n",
+                    ident, ident, ident);
+        }
+    }
+}
+
+// 输出 C++ 访问器：命名空间内的 inline 函数，返回 std::span<const std::byte> 与 std::string_view
+static void write_cpp_accessors(FILE *h, const ObjectFile *files, int fileCount, const Options *opts)
+{
+    fprintf(h, "\nnamespace %s\n{\n", opts->cppNamespace);
+    for (int f = 0; f < fileCount; f++)
+    {
+        const ObjectFile *file = &files[f];
+        for (int a = 0; a < file->assetCount; a++)
+        {
+            const Asset *asset = &file->assets[a];
+            if (asset->start < 0)
+                continue;
+
+            char ident[256];
+            asset_ident(file, a, ident, sizeof(ident));
+            to_lowercase(ident);
+            const ObjectFile *target = file;
+            const Asset *canon = canonical_asset(&target, asset);
+            const char *start = target->symbols[canon->start].name;
+
+            uint64_t size;
+            if (cpp_fixed_size(file, asset, opts, &size))
+            {
+                fprintf(h, "    inline constexpr std::size_t %s_size = %llu;\n", ident, (unsigned long long)size);
+                fprintf(h, "    static_assert(sizeof(%s) == %s_size, \"%s: declared size mismatch\");\n",
+                        start, ident, ident);
+                fprintf(h, "    inline std::span<const std::byte, %s_size> %s() noexcept\n", ident, ident);
+                fprintf(h, "    {\n");
+                fprintf(h, "        return std::span<const std::byte, %s_size>(reinterpret_cast<const std::byte *>(%s), %s_size);\n",
+                        ident, start, ident);
+                fprintf(h, "    }\n");
+                fprintf(h, "    inline std::string_view %s_str() noexcept\n", ident);
+                fprintf(h, "    {\n");
+                fprintf(h, "        return std::string_view(reinterpret_cast<const char *>(%s), %s_size);\n", start, ident);
+                fprintf(h, "    }\n");
+            }
+            else if (asset->end >= 0)
+            {
+                const char *end = target->symbols[canon->end].name;
+                fprintf(h, "    inline std::span<const std::byte> %s() noexcept\n", ident);
+                fprintf(h, "    {\n");
+                fprintf(h, "        return std::span<const std::byte>(reinterpret_cast<const std::byte *>(%s), static_cast<std::size_t>(reinterpret_cast<const char *>(%s) - reinterpret_cast<const char *>(%s)));\n",
+                        start, end, start);
+                fprintf(h, "    }\n");
+                fprintf(h, "    inline std::string_view %s_str() noexcept\n", ident);
+                fprintf(h, "    {\n");
+                fprintf(h, "        return std::string_view(reinterpret_cast<const char *>(%s), static_cast<std::size_t>(reinterpret_cast<const char *>(%s) - reinterpret_cast<const char *>(%s)));\n",
+                        start, end, start);
+                fprintf(h, "    }\n");
+            }
+        }
+    }
+    fprintf(h, "} // namespace %s\n", opts->cppNamespace);
+}
+
+// 资源是否进入注册表：需要 _start 符号，并且能从 _start/_end 或绝对 _size 符号得到大小
+static int registry_has_asset(const ObjectFile *file, int index)
+{
+    uint64_t size;
+    return file->assets[index].start >= 0 && asset_size(file, &file->assets[index], &size);
+}
+
+// 输出资源注册表：跨文件的资源 ID 枚举以及按 ID 索引的起止指针和大小数组，顺序与输入文件顺序一致；
+// 大小未知的资源不进入注册表（给出警告），避免数组中出现大小为 0 的条目
+static void write_asset_registry(FILE *h, const char *prefix, const ObjectFile *files, int fileCount,
+                                 const Options *opts)
+{
+    char lowerPrefix[256];
+    snprintf(lowerPrefix, sizeof(lowerPrefix), "%s", prefix);
+    to_lowercase(lowerPrefix);
+
+    fprintf(h, "\n// Asset IDs\n");
+    fprintf(h, "typedef enum\n{\n");
+    int id = 0;
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            if (files[f].assets[a].start < 0)
+                continue;
+            if (!registry_has_asset(&files[f], a))
+            {
+                fprintf(stderr, "Warning: size of '%s' is unknown, left out of the registry\n", files[f].assets[a].base);
+                continue;
+            }
+            char ident[256];
+            asset_ident(&files[f], a, ident, sizeof(ident));
+            to_uppercase(ident);
+            fprintf(h, "    %s_ID = %d,\n", ident, id++);
+        }
+    }
+    fprintf(h, "    %s_ASSET_COUNT = %d\n", prefix, id);
+    fprintf(h, "} %s_asset_id;\n\n", lowerPrefix);
+
+    if (id == 0)
+        return;
+
+    // SPIR-V 模式下符号声明为 uint32_t，需要转换为字节指针
+    const char *cast = opts->spirvAlign ? "(const unsigned char *)" : "";
+
+    fprintf(h, "static const unsigned char *const %s_asset_starts[%s_ASSET_COUNT] = {\n", lowerPrefix, prefix);
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            if (registry_has_asset(&files[f], a))
+                fprintf(h, "    %s%s,\n", cast, symbol_reference(&files[f], files[f].assets[a].start));
+        }
+    }
+    fprintf(h, "};\n");
+
+    fprintf(h, "static const unsigned char *const %s_asset_ends[%s_ASSET_COUNT] = {\n", lowerPrefix, prefix);
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            const Asset *asset = &files[f].assets[a];
+            uint64_t size = 0;
+            if (!registry_has_asset(&files[f], a))
+                continue;
+            // 缺少 _end 时由起始地址加 _size 得到
+            if (asset->end >= 0)
+                fprintf(h, "    %s%s,\n", cast, symbol_reference(&files[f], asset->end));
+            else
+            {
+                asset_size(&files[f], asset, &size);
+                fprintf(h, "    %s%s + %llu,\n", cast, symbol_reference(&files[f], asset->start),
+                        (unsigned long long)size);
+            }
+        }
+    }
+    fprintf(h, "};\n");
+
+    fprintf(h, "static const unsigned int %s_asset_sizes[%s_ASSET_COUNT] = {\n", lowerPrefix, prefix);
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            uint64_t size = 0;
+            if (registry_has_asset(&files[f], a) && asset_size(&files[f], &files[f].assets[a], &size))
+                fprintf(h, "    %llu,\n", (unsigned long long)size);
+        }
+    }
+    fprintf(h, "};\n");
+}
+
+// 输出 X-macro 资源列表：X(MACRO, start, end, size)，大小未知时以 end - start 的字节数表示
+static void write_asset_xmacro(FILE *h, const char *prefix, const ObjectFile *files, int fileCount)
+{
+    fprintf(h, "\n// X-macro asset list: X(MACRO, start, end, size)\n");
+    fprintf(h, "#define %s_ASSET_LIST(X)", prefix);
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            const Asset *asset = &files[f].assets[a];
+            if (asset->start < 0 || asset->end < 0)
+                continue;
+
+            char ident[256];
+            asset_ident(&files[f], a, ident, sizeof(ident));
+            to_uppercase(ident);
+            const char *start = symbol_reference(&files[f], asset->start);
+            const char *end = symbol_reference(&files[f], asset->end);
+
+            uint64_t size;
+            if (asset_size(&files[f], asset, &size))
+                fprintf(h, " \\\n    X(%s, %s, %s, %llu)", ident, start, end, (unsigned long long)size);
+            else
+                fprintf(h, " \\\n    X(%s, %s, %s, ((unsigned int)((const unsigned char *)%s - (const unsigned char *)%s)))",
+                        ident, start, end, end, start);
+        }
+    }
+    fprintf(h, "\n");
+    fprintf(h, "#ifndef ASSET_LIST\n");
+    fprintf(h, "#define ASSET_LIST(X) %s_ASSET_LIST(X)\n", prefix);
+    fprintf(h, "#endif\n");
+}
+
+// SPIR-V 反射结果
+typedef struct
+{
+    char name[128];
+    uint32_t model; // ExecutionModel
+} SpirvEntryPoint;
+
+typedef struct
+{
+    uint32_t set;
+    uint32_t binding;
+    uint32_t descriptorType; // VkDescriptorType
+    uint32_t count;          // 0 表示运行时数组
+} SpirvBinding;
+
+typedef struct
+{
+    SpirvEntryPoint *entries;
+    int entryCount;
+    SpirvBinding *bindings;
+    int bindingCount;
+} SpirvReflection;
+
+// ExecutionModel 转换为 VkShaderStageFlagBits
+static uint32_t spirv_stage_bit(uint32_t model)
+{
+    switch (model)
+    {
+    case 0: return 0x1;       // Vertex
+    case 1: return 0x2;       // TessellationControl
+    case 2: return 0x4;       // TessellationEvaluation
+    case 3: return 0x8;       // Geometry
+    case 4: return 0x10;      // Fragment
+    case 5: return 0x20;      // GLCompute
+    case 5267: case 5364: return 0x40; // Task
+    case 5268: case 5365: return 0x80; // Mesh
+    case 5313: return 0x100;  // RayGeneration
+    case 5314: return 0x200;  // AnyHit
+    case 5315: return 0x400;  // ClosestHit
+    case 5316: return 0x800;  // Miss
+    case 5317: return 0x1000; // Intersection
+    case 5318: return 0x2000; // Callable
+    default: return 0;
+    }
+}
+
+static int compare_bindings(const void *a, const void *b)
+{
+    const SpirvBinding *x = a;
+    const SpirvBinding *y = b;
+    if (x->set != y->set)
+        return x->set < y->set ? -1 : 1;
+    if (x->binding != y->binding)
+        return x->binding < y->binding ? -1 : 1;
+    return 0;
+}
+
+// 反射时会读取的类型指令的最少字数：OpTypeImage 读到 Sampled（第 8 个操作数），
+// OpTypeArray / OpTypePointer 读到第 3 个操作数，OpTypeRuntimeArray 读到元素类型
+static uint32_t spirv_type_min_words(uint32_t op)
+{
+    switch (op)
+    {
+    case 25: // OpTypeImage
+        return 9;
+    case 28: // OpTypeArray
+    case 32: // OpTypePointer
+        return 4;
+    case 29: // OpTypeRuntimeArray
+        return 3;
+    default:
+        return 2;
+    }
+}
+
+// 解析 SPIR-V 模块：入口点、执行阶段以及描述符 set/binding 布局
+static int spirv_reflect(const unsigned char *data, size_t size, SpirvReflection *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (size < 20 || size % 4 != 0)
+        return 0;
+
+    size_t count = size / 4;
+    uint32_t *words = malloc(size);
+    if (!words)
+        return 0;
+    memcpy(words, data, size);
+
+    // 处理字节序相反的模块
+    if (words[0] == 0x03022307)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t w = words[i];
+            words[i] = (w >> 24) | ((w >> 8) & 0xFF00) | ((w << 8) & 0xFF0000) | (w << 24);
+        }
+    }
+    if (words[0] != 0x07230203 || words[3] > (1u << 22))
+    {
+        free(words);
+        return 0;
+    }
+
+    uint32_t bound = words[3];
+    uint32_t *def = calloc(bound ? bound : 1, sizeof(uint32_t));          // 定义结果 ID 的指令位置
+    int64_t *set = malloc((bound ? bound : 1) * sizeof(int64_t));
+    int64_t *binding = malloc((bound ? bound : 1) * sizeof(int64_t));
+    unsigned char *bufferBlock = calloc(bound ? bound : 1, 1);
+    uint32_t *vars = malloc(count * sizeof(uint32_t));
+    if (!def || !set || !binding || !bufferBlock || !vars)
+    {
+        free(def);
+        free(set);
+        free(binding);
+        free(bufferBlock);
+        free(vars);
+        free(words);
+        return 0;
+    }
+    for (uint32_t id = 0; id < bound; id++)
+    {
+        set[id] = -1;
+        binding[id] = -1;
+    }
+
+    int varCount = 0;
+    int ok = 1;
+    size_t pos = 5;
+    while (pos < count)
+    {
+        uint32_t wordCount = words[pos] >> 16;
+        uint32_t op = words[pos] & 0xFFFF;
+        if (wordCount == 0 || pos + wordCount > count)
+        {
+            ok = 0;
+            break;
+        }
+
+        switch (op)
+        {
+        case 15: // OpEntryPoint
+            if (wordCount >= 4)
+            {
+                SpirvEntryPoint *grown = realloc(out->entries, (out->entryCount + 1) * sizeof(SpirvEntryPoint));
+                if (!grown)
+                {
+                    ok = 0;
+                    break;
+                }
+                out->entries = grown;
+                SpirvEntryPoint *ep = &out->entries[out->entryCount++];
+                ep->model = words[pos + 1];
+                size_t n = 0;
+                for (size_t k = 0; n + 1 < sizeof(ep->name) && k < (wordCount - 3) * 4; k++)
+                {
+                    char c = (char)((words[pos + 3 + k / 4] >> (8 * (k % 4))) & 0xFF);
+                    if (!c)
+                        break;
+                    ep->name[n++] = c;
+                }
+                ep->name[n] = '\0';
+            }
+            break;
+        case 71: // OpDecorate
+            if (wordCount >= 3 && words[pos + 1] < bound)
+            {
+                uint32_t target = words[pos + 1];
+                uint32_t decoration = words[pos + 2];
+                if (decoration == 34 && wordCount >= 4) // DescriptorSet
+                    set[target] = words[pos + 3];
+                else if (decoration == 33 && wordCount >= 4) // Binding
+                    binding[target] = words[pos + 3];
+                else if (decoration == 3) // BufferBlock
+                    bufferBlock[target] = 1;
+            }
+            break;
+        case 25: case 26: case 27: case 28: case 29: case 30: case 32: case 5341:
+            // OpTypeImage/Sampler/SampledImage/Array/RuntimeArray/Struct/Pointer/AccelerationStructureKHR；
+            // 只记录长度足以容纳之后读取的全部操作数的指令，否则畸形模块会越界读取
+            if (wordCount >= spirv_type_min_words(op) && words[pos + 1] < bound)
+                def[words[pos + 1]] = (uint32_t)pos;
+            break;
+        case 43: // OpConstant
+            if (wordCount >= 4 && words[pos + 2] < bound)
+                def[words[pos + 2]] = (uint32_t)pos;
+            break;
+        case 59: // OpVariable
+            if (wordCount >= 4 && words[pos + 2] < bound)
+                vars[varCount++] = (uint32_t)pos;
+            break;
+        }
+        if (!ok)
+            break;
+        pos += wordCount;
+    }
+
+    for (int v = 0; ok && v < varCount; v++)
+    {
+        uint32_t vp = vars[v];
+        uint32_t id = words[vp + 2];
+        uint32_t storage = words[vp + 3];
+        // 只有 UniformConstant(0)、Uniform(2)、StorageBuffer(12) 会占用描述符
+        if ((storage != 0 && storage != 2 && storage != 12) || binding[id] < 0)
+            continue;
+
+        uint32_t typeId = words[vp + 1];
+        if (typeId >= bound || !def[typeId] || (words[def[typeId]] & 0xFFFF) != 32)
+            continue;
+        typeId = words[def[typeId] + 3];
+
+        // 展开数组类型
+        uint32_t arrayCount = 1;
+        for (uint32_t depth = 0; typeId < bound && def[typeId] && depth < bound; depth++) // 畸形模块可能有环
+        {
+            uint32_t tp = def[typeId];
+            uint32_t top = words[tp] & 0xFFFF;
+            if (top == 28)
+            {
+                uint32_t lengthId = words[tp + 3];
+                if (lengthId < bound && def[lengthId] && (words[def[lengthId]] & 0xFFFF) == 43) // OpConstant
+                    arrayCount *= words[def[lengthId] + 3];
+                typeId = words[tp + 2];
+            }
+            else if (top == 29)
+            {
+                arrayCount = 0;
+                typeId = words[tp + 2];
+            }
+            else
+            {
+                break;
+            }
+        }
+        if (typeId >= bound || !def[typeId])
+            continue;
+
+        uint32_t tp = def[typeId];
+        uint32_t top = words[tp] & 0xFFFF;
+        uint32_t type;
+        if (top == 30) // OpTypeStruct
+            type = (storage == 12 || bufferBlock[typeId]) ? 7 : 6; // STORAGE_BUFFER / UNIFORM_BUFFER
+        else if (top == 25) // OpTypeImage
+        {
+            uint32_t dim = words[tp + 3];
+            uint32_t sampled = words[tp + 7];
+            if (dim == 5) // Buffer
+                type = sampled == 2 ? 5 : 4; // STORAGE_TEXEL_BUFFER / UNIFORM_TEXEL_BUFFER
+            else if (dim == 6) // SubpassData
+                type = 10; // INPUT_ATTACHMENT
+            else
+                type = sampled == 2 ? 3 : 2; // STORAGE_IMAGE / SAMPLED_IMAGE
+        }
+        else if (top == 26)
+            type = 0; // SAMPLER
+        else if (top == 27)
+            type = 1; // COMBINED_IMAGE_SAMPLER
+        else if (top == 5341)
+            type = 1000150000; // ACCELERATION_STRUCTURE_KHR
+        else
+            continue;
+
+        SpirvBinding *grown = realloc(out->bindings, (out->bindingCount + 1) * sizeof(SpirvBinding));
+        if (!grown)
+        {
+            ok = 0;
+            break;
+        }
+        out->bindings = grown;
+        SpirvBinding *b = &out->bindings[out->bindingCount++];
+        b->set = set[id] < 0 ? 0 : (uint32_t)set[id];
+        b->binding = (uint32_t)binding[id];
+        b->descriptorType = type;
+        b->count = arrayCount;
+    }
+
+    if (ok && out->bindingCount > 1)
+        qsort(out->bindings, out->bindingCount, sizeof(SpirvBinding), compare_bindings);
+
+    free(def);
+    free(set);
+    free(binding);
+    free(bufferBlock);
+    free(vars);
+    free(words);
+    if (!ok)
+    {
+        free(out->entries);
+        free(out->bindings);
+        memset(out, 0, sizeof(*out));
+    }
+    return ok;
+}
+
+// 输出 SPIR-V 反射常量：入口点名称、执行阶段，以及按 set 分组的 VkDescriptorSetLayoutBinding 初始化器
+static void write_spirv_reflection(FILE *h, const ObjectFile *files, int fileCount)
+{
+    int header = 0;
+    for (int f = 0; f < fileCount; f++)
+    {
+        const ObjectFile *file = &files[f];
+        for (int a = 0; a < file->assetCount; a++)
+        {
+            unsigned char *data;
+            size_t size;
+            if (!read_asset_payload(file, &file->assets[a], &data, &size))
+                continue;
+
+            SpirvReflection r;
+            int ok = spirv_reflect(data, size, &r);
+            free(data);
+            if (!ok)
+                continue;
+
+            if (!header)
+            {
+                fprintf(h, "\n// SPIR-V reflection (bindings: {binding, VkDescriptorType, descriptorCount, stageFlags, pImmutableSamplers})\n");
+                header = 1;
+            }
+
+            char ident[256];
+            asset_ident(file, a, ident, sizeof(ident));
+            to_uppercase(ident);
+
+            uint32_t stages = 0;
+            for (int e = 0; e < r.entryCount; e++)
+                stages |= spirv_stage_bit(r.entries[e].model);
+
+            if (r.entryCount > 0)
+            {
+                fprintf(h, "#define %s_ENTRY_POINT \"%s\"\n", ident, r.entries[0].name);
+                fprintf(h, "#define %s_STAGE 0x%08Xu\n", ident, spirv_stage_bit(r.entries[0].model));
+            }
+            if (r.entryCount > 1)
+            {
+                fprintf(h, "#define %s_ENTRY_POINT_COUNT %d\n", ident, r.entryCount);
+                fprintf(h, "#define %s_ENTRY_POINTS {", ident);
+                for (int e = 0; e < r.entryCount; e++)
+                    fprintf(h, "%s{\"%s\", 0x%08Xu}", e ? ", " : "", r.entries[e].name, spirv_stage_bit(r.entries[e].model));
+                fprintf(h, "}\n");
+            }
+            fprintf(h, "#define %s_STAGES 0x%08Xu\n", ident, stages);
+
+            // 按 set 输出绑定，set 编号不连续时中间的 set 为空
+            uint32_t setCount = r.bindingCount > 0 ? r.bindings[r.bindingCount - 1].set + 1 : 0;
+            fprintf(h, "#define %s_SET_COUNT %u\n", ident, setCount);
+            for (int b = 0; b < r.bindingCount;)
+            {
+                uint32_t s = r.bindings[b].set;
+                int n = 0;
+                while (b + n < r.bindingCount && r.bindings[b + n].set == s)
+                    n++;
+                fprintf(h, "#define %s_SET%u_BINDING_COUNT %d\n", ident, s, n);
+                fprintf(h, "#define %s_SET%u_BINDINGS {", ident, s);
+                for (int k = 0; k < n; k++)
+                {
+                    const SpirvBinding *sb = &r.bindings[b + k];
+                    fprintf(h, "%s{%u, %u, %u, 0x%08Xu, NULL}", k ? ", " : "", sb->binding, sb->descriptorType, sb->count, stages);
+                }
+                fprintf(h, "}\n");
+                b += n;
+            }
+
+            free(r.entries);
+            free(r.bindings);
+        }
+    }
+}
+
+// SPIR-V 调试指令：OpSourceContinued、OpSource、OpSourceExtension、OpName、OpMemberName、OpString、
+// OpLine、OpNoLine、OpModuleProcessed
+static int spirv_is_debug_op(uint32_t op)
+{
+    return (op >= 2 && op <= 8) || op == 317 || op == 330;
+}
+
+// 原地剥离 SPIR-V 调试指令，返回新的大小；不是（小端）SPIR-V 或格式有误时保持原样。
+// 使用 NonSemantic 调试信息扩展时 OpString 仍被其引用，此时保留 OpString
+static size_t strip_spirv_debug(unsigned char *data, size_t size)
+{
+    if (size < 20 || size % 4 != 0 || read_le32(data) != 0x07230203)
+        return size;
+
+    int keepStrings = 0;
+    for (size_t pos = 20; pos < size;)
+    {
+        uint32_t word = read_le32(data + pos);
+        size_t wordCount = word >> 16;
+        if (wordCount == 0 || pos + wordCount * 4 > size)
+            return size;
+        if ((word & 0xFFFF) == 11 && wordCount >= 3 && // OpExtInstImport
+            strncmp((const char *)data + pos + 8, "NonSemantic.", 12) == 0)
+            keepStrings = 1;
+        pos += wordCount * 4;
+    }
+
+    size_t out = 20;
+    for (size_t pos = 20; pos < size;)
+    {
+        uint32_t word = read_le32(data + pos);
+        size_t bytes = (word >> 16) * 4;
+        uint32_t op = word & 0xFFFF;
+        if (!spirv_is_debug_op(op) || (op == 7 && keepStrings))
+        {
+            memmove(data + out, data + pos, bytes);
+            out += bytes;
+        }
+        pos += bytes;
+    }
+    return out;
+}
+
+// 输出资源内容哈希（XXH64，种子 0），可直接用作管线缓存键或去重键
+static void write_asset_hashes(FILE *h, const ObjectFile *files, int fileCount)
+{
+    fprintf(h, "\n// Content hashes (XXH64, seed 0)\n");
+    for (int f = 0; f < fileCount; f++)
+    {
+        const ObjectFile *file = &files[f];
+        for (int a = 0; a < file->assetCount; a++)
+        {
+            unsigned char *data;
+            size_t size;
+            if (!read_asset_payload(file, &file->assets[a], &data, &size))
+                continue;
+
+            char ident[256];
+            asset_ident(file, a, ident, sizeof(ident));
+            to_uppercase(ident);
+            fprintf(h, "#define %s_HASH 0x%016llXULL\n", ident, (unsigned long long)xxh64(data, size, 0));
+            free(data);
+        }
+    }
+}
+
+// 输出大资源的分块表：把 _start.._end 按固定大小分块，记录每块的偏移、大小和 XXH64，
+// 调用方可以只映射、校验或解压用到的块
+static void write_chunk_tables(FILE *h, const ObjectFile *files, int fileCount, const Options *opts)
+{
+    int printed = 0;
+    for (int f = 0; f < fileCount; f++)
+    {
+        const ObjectFile *file = &files[f];
+        for (int a = 0; a < file->assetCount; a++)
+        {
+            uint64_t size;
+            if (file->assets[a].start < 0 || !asset_size(file, &file->assets[a], &size) ||
+                size <= opts->chunkThreshold)
+                continue;
+
+            char upper[256];
+            char lower[256];
+            asset_ident(file, a, upper, sizeof(upper));
+            snprintf(lower, sizeof(lower), "%s", upper);
+            to_uppercase(upper);
+            to_lowercase(lower);
+            // 表中的偏移和大小为 32 位
+            if (size > 0xFFFFFFFFULL)
+            {
+                fprintf(stderr, "Warning: '%s' is larger than 4 GiB, no chunk table emitted\n", file->assets[a].base);
+                continue;
+            }
+
+            if (!printed)
+            {
+                fprintf(h, "\n// Chunk tables: fixed-size pages of large assets as (offset, size, XXH64 with seed 0)\n");
+                fprintf(h, "#ifndef SG_ASSET_CHUNK_DEFINED\n");
+                fprintf(h, "#define SG_ASSET_CHUNK_DEFINED\n");
+                fprintf(h, "#include <stdint.h>\n");
+                fprintf(h, "typedef struct\n{\n");
+                fprintf(h, "    uint32_t offset;\n");
+                fprintf(h, "    uint32_t size;\n");
+                fprintf(h, "    uint64_t hash;\n");
+                fprintf(h, "} sg_asset_chunk;\n");
+                fprintf(h, "#endif\n");
+                printed = 1;
+            }
+
+            // 去重后的重复资源与规范资源内容相同，规范资源的表在同一头文件中时只输出别名宏
+            const Asset *asset = &file->assets[a];
+            if (asset->aliasFile && file_in_set(asset->aliasFile, files, fileCount))
+            {
+                char canonUpper[256];
+                char canonLower[256];
+                asset_ident(asset->aliasFile, asset->aliasAsset, canonUpper, sizeof(canonUpper));
+                snprintf(canonLower, sizeof(canonLower), "%s", canonUpper);
+                to_uppercase(canonUpper);
+                to_lowercase(canonLower);
+                fprintf(h, "#define %s_CHUNK_SIZE %s_CHUNK_SIZE\n", upper, canonUpper);
+                fprintf(h, "#define %s_CHUNK_COUNT %s_CHUNK_COUNT\n", upper, canonUpper);
+                fprintf(h, "#define %s_chunks %s_chunks\n", lower, canonLower);
+                continue;
+            }
+
+            unsigned char *data;
+            size_t dataSize;
+            if (!read_asset_payload(file, &file->assets[a], &data, &dataSize))
+                continue;
+
+            size_t chunkCount = (dataSize + opts->chunkSize - 1) / opts->chunkSize;
+            fprintf(h, "#define %s_CHUNK_SIZE %u\n", upper, opts->chunkSize);
+            fprintf(h, "#define %s_CHUNK_COUNT %llu\n", upper, (unsigned long long)chunkCount);
+            fprintf(h, "static const sg_asset_chunk %s_chunks[%s_CHUNK_COUNT] = {\n", lower, upper);
+            for (size_t offset = 0; offset < dataSize; offset += opts->chunkSize)
+            {
+                size_t n = dataSize - offset < opts->chunkSize ? dataSize - offset : opts->chunkSize;
+                fprintf(h, "    {%llu, %llu, 0x%016llXULL},\n", (unsigned long long)offset, (unsigned long long)n,
+                        (unsigned long long)xxh64(data + offset, n, 0));
+            }
+            fprintf(h, "};\n");
+            free(data);
+        }
+    }
+}
+
+// 写入零字节直到 *pos 到达 target，*pos 为调用方跟踪的 64 位写入位置
+static int pad_output(FILE *f, uint64_t *pos, uint64_t target)
+{
+    static const unsigned char zeros[4096];
+    while (*pos < target)
+    {
+        size_t n = target - *pos < sizeof(zeros) ? (size_t)(target - *pos) : sizeof(zeros);
+        if (fwrite(zeros, 1, n, f) != n)
+            return 0;
+        *pos += n;
+    }
+    return 1;
+}
+
+// 资源包中每个资源数据的最小对齐：一条缓存行
+#define PACK_ALIGN 64
+#define PACK_VERSION 1
+
+// 输出资源包的读取辅助：包格式定义和在映射的包中按名称哈希二分查找的函数，
+// 以及每个资源的 ID、名称哈希和在包中的偏移、大小（资源包由 write_pack 写出）
+static void write_pack_index(FILE *h, const char *prefix, const ObjectFile *files, int fileCount, const Options *opts)
+{
+    char lowerPrefix[256];
+    snprintf(lowerPrefix, sizeof(lowerPrefix), "%s", prefix);
+    to_lowercase(lowerPrefix);
+    char packPath[1024];
+    display_path(packPath, sizeof(packPath), opts->pack, opts);
+
+    fprintf(h, "\n// Asset pack %s: 64-byte header, index sorted by XXH64 of the asset name, aligned payloads\n",
+            packPath);
+    fprintf(h, "#ifndef SG_PACK_DEFINED\n");
+    fprintf(h, "#define SG_PACK_DEFINED\n");
+    fprintf(h, "#include <stddef.h>\n");
+    fprintf(h, "#include <stdint.h>\n");
+    fprintf(h, "#include <string.h>\n");
+    fprintf(h, "#define SG_PACK_VERSION %d\n", PACK_VERSION);
+    fprintf(h, "typedef struct\n{\n");
+    fprintf(h, "    char magic[4]; // \"SGPK\"\n");
+    fprintf(h, "    uint32_t version;\n");
+    fprintf(h, "    uint32_t count;\n");
+    fprintf(h, "    uint32_t align;\n");
+    fprintf(h, "    uint64_t index_offset;\n");
+    fprintf(h, "    uint64_t data_offset;\n");
+    fprintf(h, "    uint64_t file_size;\n");
+    fprintf(h, "    uint64_t reserved[3];\n");
+    fprintf(h, "} sg_pack_header;\n");
+    fprintf(h, "typedef struct\n{\n");
+    fprintf(h, "    uint64_t hash;\n");
+    fprintf(h, "    uint64_t offset;\n");
+    fprintf(h, "    uint64_t size;\n");
+    fprintf(h, "} sg_pack_entry;\n");
+    fprintf(h, "// Find an asset by name hash in a mapped pack; NULL if it is missing or the pack is malformed\n");
+    fprintf(h, "static inline const unsigned char *sg_pack_find(const void *pack, size_t pack_size, uint64_t hash, size_t *size)\n");
+    fprintf(h, "{\n");
+    fprintf(h, "    const sg_pack_header *header = (const sg_pack_header *)pack;\n");
+    fprintf(h, "    if (pack_size < sizeof(sg_pack_header) || memcmp(header->magic, \"SGPK\", 4) != 0 ||\n");
+    fprintf(h, "        header->version != SG_PACK_VERSION || header->index_offset > pack_size ||\n");
+    fprintf(h, "        header->count > (pack_size - header->index_offset) / sizeof(sg_pack_entry))\n");
+    fprintf(h, "        return NULL;\n");
+    fprintf(h, "    const sg_pack_entry *index = (const sg_pack_entry *)((const unsigned char *)pack + header->index_offset);\n");
+    fprintf(h, "    size_t lo = 0;\n");
+    fprintf(h, "    size_t hi = header->count;\n");
+    fprintf(h, "    while (lo < hi)\n");
+    fprintf(h, "    {\n");
+    fprintf(h, "        size_t mid = lo + (hi - lo) / 2;\n");
+    fprintf(h, "        if (index[mid].hash < hash)\n");
+    fprintf(h, "            lo = mid + 1;\n");
+    fprintf(h, "        else\n");
+    fprintf(h, "            hi = mid;\n");
+    fprintf(h, "    }\n");
+    fprintf(h, "    if (lo == header->count || index[lo].hash != hash || index[lo].offset > pack_size ||\n");
+    fprintf(h, "        index[lo].size > pack_size - index[lo].offset)\n");
+    fprintf(h, "        return NULL;\n");
+    fprintf(h, "    if (size)\n");
+    fprintf(h, "        *size = (size_t)index[lo].size;\n");
+    fprintf(h, "    return (const unsigned char *)pack + index[lo].offset;\n");
+    fprintf(h, "}\n");
+    fprintf(h, "#endif\n\n");
+
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            if (files[f].assets[a].packOffset < 0)
+                continue;
+            char ident[256];
+            char upper[256];
+            asset_ident(&files[f], a, ident, sizeof(ident));
+            snprintf(upper, sizeof(upper), "%s", ident);
+            to_uppercase(upper);
+            fprintf(h, "#define %s_PACK_HASH 0x%016llXULL\n", upper,
+                    (unsigned long long)xxh64(ident, strlen(ident), 0));
+        }
+    }
+
+    fprintf(h, "typedef enum\n{\n");
+    int id = 0;
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            if (files[f].assets[a].packOffset < 0)
+                continue;
+            char ident[256];
+            asset_ident(&files[f], a, ident, sizeof(ident));
+            to_uppercase(ident);
+            fprintf(h, "    %s_PACK_ID = %d,\n", ident, id++);
+        }
+    }
+    fprintf(h, "    %s_PACK_COUNT = %d\n", prefix, id);
+    fprintf(h, "} %s_pack_id;\n", lowerPrefix);
+
+    if (id == 0)
+        return;
+
+    fprintf(h, "static const uint64_t %s_pack_offsets[%s_PACK_COUNT] = {\n", lowerPrefix, prefix);
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            if (files[f].assets[a].packOffset >= 0)
+                fprintf(h, "    %lluULL,\n", (unsigned long long)files[f].assets[a].packOffset);
+        }
+    }
+    fprintf(h, "};\n");
+
+    fprintf(h, "static const uint64_t %s_pack_sizes[%s_PACK_COUNT] = {\n", lowerPrefix, prefix);
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            uint64_t size = 0;
+            if (files[f].assets[a].packOffset < 0)
+                continue;
+            asset_size(&files[f], &files[f].assets[a], &size);
+            fprintf(h, "    %lluULL,\n", (unsigned long long)size);
+        }
+    }
+    fprintf(h, "};\n");
+}
+
+// 输出延迟解析的访问器：<名称>_data(&size) 第一次调用时解析到 <前缀>_use_pack() 映射的资源包中的数据，
+// 包中没有该资源或没有配置资源包时退回到嵌入的符号，结果缓存在生成的表中。实现按 stb 的方式放在
+// <前缀>_IMPLEMENTATION 之后，只在一个源文件中展开；展开时定义 <前缀>_PACK_ONLY 则不引用嵌入的符号，
+// 开发构建可以不链接资源对象，资源变化时只需要重新生成资源包
+static void write_lazy_accessors(FILE *h, const char *prefix, const ObjectFile *files, int fileCount,
+                                 const Options *opts)
+{
+    char lowerPrefix[256];
+    snprintf(lowerPrefix, sizeof(lowerPrefix), "%s", prefix);
+    to_lowercase(lowerPrefix);
+
+    int count = 0;
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            if (files[f].assets[a].packOffset >= 0)
+                count++;
+        }
+    }
+    if (count == 0)
+        return;
+
+    fprintf(h, "\n// Lazy accessors: <name>_data(&size) resolves once to the pack mapped by %s_use_pack(),\n",
+            lowerPrefix);
+    fprintf(h, "// falling back to the embedded symbols. Define %s_IMPLEMENTATION in exactly one source file;\n",
+            prefix);
+    fprintf(h, "// also define %s_PACK_ONLY there to leave the embedded payloads out of the link\n", prefix);
+    fprintf(h, "int %s_use_pack(const char *path);\n", lowerPrefix);
+    fprintf(h, "const unsigned char *%s_asset_data(%s_pack_id id, size_t *size);\n", lowerPrefix, lowerPrefix);
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            if (files[f].assets[a].packOffset < 0)
+                continue;
+            char upper[256];
+            char lower[256];
+            asset_ident(&files[f], a, upper, sizeof(upper));
+            snprintf(lower, sizeof(lower), "%s", upper);
+            to_uppercase(upper);
+            to_lowercase(lower);
+            fprintf(h, "static inline const unsigned char *%s_data(size_t *size)\n", lower);
+            fprintf(h, "{\n");
+            fprintf(h, "    return %s_asset_data(%s_PACK_ID, size);\n", lowerPrefix, upper);
+            fprintf(h, "}\n");
+        }
+    }
+
+    fprintf(h, "\n#ifdef %s_IMPLEMENTATION\n", prefix);
+    fprintf(h, "#include <stdlib.h>\n");
+    fprintf(h, "#if defined(__unix__) || defined(__APPLE__)\n");
+    fprintf(h, "#include <fcntl.h>\n");
+    fprintf(h, "#include <sys/mman.h>\n");
+    fprintf(h, "#include <sys/stat.h>\n");
+    fprintf(h, "#include <unistd.h>\n");
+    fprintf(h, "#else\n");
+    fprintf(h, "#include <stdio.h>\n");
+    fprintf(h, "#endif\n");
+
+    fprintf(h, "static const uint64_t %s_lazy_hashes[%s_PACK_COUNT] = {\n", lowerPrefix, prefix);
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            if (files[f].assets[a].packOffset < 0)
+                continue;
+            char ident[256];
+            asset_ident(&files[f], a, ident, sizeof(ident));
+            to_uppercase(ident);
+            fprintf(h, "    %s_PACK_HASH,\n", ident);
+        }
+    }
+    fprintf(h, "};\n");
+
+    // SPIR-V 模式下符号声明为 uint32_t，需要转换为字节指针；缺少 _end 时由起始地址加 _size 得到，
+    // 与资源包中记录的大小一致
+    const char *cast = opts->spirvAlign ? "(const unsigned char *)" : "";
+    fprintf(h, "#ifndef %s_PACK_ONLY\n", prefix);
+    fprintf(h, "static const unsigned char *const %s_lazy_starts[%s_PACK_COUNT] = {\n", lowerPrefix, prefix);
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            const Asset *asset = &files[f].assets[a];
+            if (asset->packOffset >= 0)
+                fprintf(h, "    %s%s,\n", cast, symbol_reference(&files[f], asset->start));
+        }
+    }
+    fprintf(h, "};\n");
+    fprintf(h, "static const unsigned char *const %s_lazy_ends[%s_PACK_COUNT] = {\n", lowerPrefix, prefix);
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            const Asset *asset = &files[f].assets[a];
+            uint64_t size = 0;
+            if (asset->packOffset < 0)
+                continue;
+            if (asset->end >= 0)
+                fprintf(h, "    %s%s,\n", cast, symbol_reference(&files[f], asset->end));
+            else
+            {
+                asset_size(&files[f], asset, &size);
+                fprintf(h, "    %s%s + %llu,\n", cast, symbol_reference(&files[f], asset->start),
+                        (unsigned long long)size);
+            }
+        }
+    }
+    fprintf(h, "};\n");
+    fprintf(h, "#endif\n");
+
+    fprintf(h, "static const unsigned char *%s_lazy_pack;\n", lowerPrefix);
+    fprintf(h, "static size_t %s_lazy_pack_size;\n", lowerPrefix);
+    fprintf(h, "static const unsigned char *%s_lazy_data[%s_PACK_COUNT];\n", lowerPrefix, prefix);
+    fprintf(h, "static size_t %s_lazy_sizes[%s_PACK_COUNT];\n", lowerPrefix, prefix);
+    fprintf(h, "static unsigned char %s_lazy_resolved[%s_PACK_COUNT];\n", lowerPrefix, prefix);
+
+    // 之前映射的资源包不会解除映射，已经返回的指针保持有效
+    fprintf(h, "// Map a pack and re-resolve assets on next use; a previously mapped pack stays mapped.\n");
+    fprintf(h, "// Resolution is not synchronized: configure the pack before other threads access assets\n");
+    fprintf(h, "int %s_use_pack(const char *path)\n", lowerPrefix);
+    fprintf(h, "{\n");
+    fprintf(h, "    const unsigned char *pack;\n");
+    fprintf(h, "    size_t size;\n");
+    fprintf(h, "#if defined(__unix__) || defined(__APPLE__)\n");
+    fprintf(h, "    int fd = open(path, O_RDONLY);\n");
+    fprintf(h, "    if (fd < 0)\n");
+    fprintf(h, "        return 0;\n");
+    fprintf(h, "    struct stat st;\n");
+    fprintf(h, "    void *map = MAP_FAILED;\n");
+    fprintf(h, "    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(sg_pack_header))\n");
+    fprintf(h, "        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);\n");
+    fprintf(h, "    close(fd);\n");
+    fprintf(h, "    if (map == MAP_FAILED)\n");
+    fprintf(h, "        return 0;\n");
+    fprintf(h, "    pack = (const unsigned char *)map;\n");
+    fprintf(h, "    size = (size_t)st.st_size;\n");
+    fprintf(h, "#else\n");
+    fprintf(h, "    // No mmap: read the whole pack into memory\n");
+    fprintf(h, "    FILE *f = fopen(path, \"rb\");\n");
+    fprintf(h, "    if (!f)\n");
+    fprintf(h, "        return 0;\n");
+    fprintf(h, "    long end = fseek(f, 0, SEEK_END) == 0 ? ftell(f) : -1;\n");
+    fprintf(h, "    unsigned char *buf = end >= (long)sizeof(sg_pack_header) ? (unsigned char *)malloc((size_t)end) : NULL;\n");
+    fprintf(h, "    if (buf && (fseek(f, 0, SEEK_SET) != 0 || fread(buf, 1, (size_t)end, f) != (size_t)end))\n");
+    fprintf(h, "    {\n");
+    fprintf(h, "        free(buf);\n");
+    fprintf(h, "        buf = NULL;\n");
+    fprintf(h, "    }\n");
+    fprintf(h, "    fclose(f);\n");
+    fprintf(h, "    if (!buf)\n");
+    fprintf(h, "        return 0;\n");
+    fprintf(h, "    pack = buf;\n");
+    fprintf(h, "    size = (size_t)end;\n");
+    fprintf(h, "#endif\n");
+    fprintf(h, "    const sg_pack_header *header = (const sg_pack_header *)pack;\n");
+    fprintf(h, "    if (memcmp(header->magic, \"SGPK\", 4) != 0 || header->version != SG_PACK_VERSION)\n");
+    fprintf(h, "    {\n");
+    fprintf(h, "#if defined(__unix__) || defined(__APPLE__)\n");
+    fprintf(h, "        munmap((void *)pack, size);\n");
+    fprintf(h, "#else\n");
+    fprintf(h, "        free((void *)pack);\n");
+    fprintf(h, "#endif\n");
+    fprintf(h, "        return 0;\n");
+    fprintf(h, "    }\n");
+    fprintf(h, "    %s_lazy_pack = pack;\n", lowerPrefix);
+    fprintf(h, "    %s_lazy_pack_size = size;\n", lowerPrefix);
+    fprintf(h, "    memset(%s_lazy_resolved, 0, sizeof(%s_lazy_resolved));\n", lowerPrefix, lowerPrefix);
+    fprintf(h, "    return 1;\n");
+    fprintf(h, "}\n");
+
+    fprintf(h, "const unsigned char *%s_asset_data(%s_pack_id id, size_t *size)\n", lowerPrefix, lowerPrefix);
+    fprintf(h, "{\n");
+    fprintf(h, "    if ((unsigned)id >= (unsigned)%s_PACK_COUNT)\n", prefix);
+    fprintf(h, "    {\n");
+    fprintf(h, "        if (size)\n");
+    fprintf(h, "            *size = 0;\n");
+    fprintf(h, "        return NULL;\n");
+    fprintf(h, "    }\n");
+    fprintf(h, "    if (!%s_lazy_resolved[id])\n", lowerPrefix);
+    fprintf(h, "    {\n");
+    fprintf(h, "        size_t n = 0;\n");
+    fprintf(h, "        const unsigned char *data = NULL;\n");
+    fprintf(h, "        if (%s_lazy_pack)\n", lowerPrefix);
+    fprintf(h, "            data = sg_pack_find(%s_lazy_pack, %s_lazy_pack_size, %s_lazy_hashes[id], &n);\n",
+            lowerPrefix, lowerPrefix, lowerPrefix);
+    fprintf(h, "#ifndef %s_PACK_ONLY\n", prefix);
+    fprintf(h, "        if (!data)\n");
+    fprintf(h, "        {\n");
+    fprintf(h, "            data = %s_lazy_starts[id];\n", lowerPrefix);
+    fprintf(h, "            n = (size_t)(%s_lazy_ends[id] - %s_lazy_starts[id]);\n", lowerPrefix, lowerPrefix);
+    fprintf(h, "        }\n");
+    fprintf(h, "#endif\n");
+    fprintf(h, "        %s_lazy_data[id] = data;\n", lowerPrefix);
+    fprintf(h, "        %s_lazy_sizes[id] = n;\n", lowerPrefix);
+    fprintf(h, "        %s_lazy_resolved[id] = 1;\n", lowerPrefix);
+    fprintf(h, "    }\n");
+    fprintf(h, "    if (size)\n");
+    fprintf(h, "        *size = %s_lazy_sizes[id];\n", lowerPrefix);
+    fprintf(h, "    return %s_lazy_data[id];\n", lowerPrefix);
+    fprintf(h, "}\n");
+    fprintf(h, "#endif // %s_IMPLEMENTATION\n", prefix);
+}
+
+// 不区分大小写比较前 len 个字符（避免依赖 POSIX 的 strncasecmp）
+static int ident_equal_nocase(const char *a, const char *b, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        if (tolower((unsigned char)a[i]) != tolower((unsigned char)b[i]))
+            return 0;
+    }
+    return 1;
+}
+
+// 判断资源是否在逗号分隔的名称列表中（按标识符匹配时不区分大小写，按符号前缀匹配时可省略 _binary_）
+static int asset_in_list(const ObjectFile *file, int index, const char *list)
+{
+    char ident[256];
+    asset_ident(file, index, ident, sizeof(ident));
+    const char *base = file->assets[index].base;
+    const char *origBase = file->assets[index].origBase;
+
+    const char *p = list;
+    while (*p)
+    {
+        const char *comma = strchr(p, ',');
+        size_t len = comma ? (size_t)(comma - p) : strlen(p);
+        if (len > 0 && ((strlen(ident) == len && ident_equal_nocase(ident, p, len)) ||
+                        (strlen(base) == len && strncmp(base, p, len) == 0) ||
+                        (strncmp(base, "_binary_", 8) == 0 && strlen(base + 8) == len && strncmp(base + 8, p, len) == 0) ||
+                        (origBase && strlen(origBase) == len && strncmp(origBase, p, len) == 0)))
+            return 1;
+        p += len;
+        if (*p == ',')
+            p++;
+    }
+    return 0;
+}
+
+// 输出预取辅助函数：对每个资源的 _start.._end 页范围发出 WILLNEED 提示，
+// 以及预取整个头文件中全部资源和 --hot 资源的函数
+static void write_prefetch_helpers(FILE *h, const char *prefix, const ObjectFile *files, int fileCount, const Options *opts)
+{
+    char lowerPrefix[256];
+    snprintf(lowerPrefix, sizeof(lowerPrefix), "%s", prefix);
+    to_lowercase(lowerPrefix);
+
+    fprintf(h, "\n// Prefetch helpers: advise the kernel to page in asset ranges ahead of first use\n");
+    fprintf(h, "#ifndef SG_PREFETCH_RANGE_DEFINED\n");
+    fprintf(h, "#define SG_PREFETCH_RANGE_DEFINED\n");
+    fprintf(h, "#if defined(__unix__) || defined(__APPLE__)\n");
+    fprintf(h, "#include <sys/mman.h>\n");
+    fprintf(h, "#endif\n");
+    fprintf(h, "#ifdef POSIX_MADV_WILLNEED\n");
+    fprintf(h, "#include <stdint.h>\n");
+    fprintf(h, "#include <unistd.h>\n");
+    fprintf(h, "static inline void sg_prefetch_range(const void *start, const void *end)\n");
+    fprintf(h, "{\n");
+    fprintf(h, "    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);\n");
+    fprintf(h, "    uintptr_t lo = (uintptr_t)start & ~(page - 1);\n");
+    fprintf(h, "    uintptr_t hi = (uintptr_t)end;\n");
+    fprintf(h, "    if (hi > lo)\n");
+    fprintf(h, "        posix_madvise((void *)lo, hi - lo, POSIX_MADV_WILLNEED);\n");
+    fprintf(h, "}\n");
+    fprintf(h, "#else\n");
+    fprintf(h, "// No advise API available (or hidden by a strict -std mode): touch one byte per 4 KiB page instead\n");
+    fprintf(h, "static inline void sg_prefetch_range(const void *start, const void *end)\n");
+    fprintf(h, "{\n");
+    fprintf(h, "    const volatile unsigned char *p = (const volatile unsigned char *)start;\n");
+    fprintf(h, "    const volatile unsigned char *e = (const volatile unsigned char *)end;\n");
+    fprintf(h, "    for (; p < e; p += 4096)\n");
+    fprintf(h, "        (void)*p;\n");
+    fprintf(h, "}\n");
+    fprintf(h, "#endif\n");
+    fprintf(h, "#endif\n\n");
+
+    int hotCount = 0;
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            const Asset *asset = &files[f].assets[a];
+            if (asset->start < 0 || asset->end < 0)
+                continue;
+            char ident[256];
+            asset_ident(&files[f], a, ident, sizeof(ident));
+            to_lowercase(ident);
+            fprintf(h, "static inline void %s_prefetch(void)\n", ident);
+            fprintf(h, "{\n");
+            fprintf(h, "    sg_prefetch_range(%s, %s);\n", symbol_reference(&files[f], asset->start),
+                    symbol_reference(&files[f], asset->end));
+            fprintf(h, "}\n");
+            if (opts->hotList && asset_in_list(&files[f], a, opts->hotList))
+                hotCount++;
+        }
+    }
+
+    // 分组预取：重复资源与规范资源共用页面，只预取一次
+    fprintf(h, "static inline void %s_prefetch_all(void)\n", lowerPrefix);
+    fprintf(h, "{\n");
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            const Asset *asset = &files[f].assets[a];
+            if (asset->start < 0 || asset->end < 0 || asset->aliasFile)
+                continue;
+            char ident[256];
+            asset_ident(&files[f], a, ident, sizeof(ident));
+            to_lowercase(ident);
+            fprintf(h, "    %s_prefetch();\n", ident);
+        }
+    }
+    fprintf(h, "}\n");
+
+    if (hotCount == 0)
+        return;
+
+    fprintf(h, "static inline void %s_preload_hot(void)\n", lowerPrefix);
+    fprintf(h, "{\n");
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            const Asset *asset = &files[f].assets[a];
+            if (asset->start < 0 || asset->end < 0 || !asset_in_list(&files[f], a, opts->hotList))
+                continue;
+            char ident[256];
+            asset_ident(&files[f], a, ident, sizeof(ident));
+            to_lowercase(ident);
+            fprintf(h, "    %s_prefetch();\n", ident);
+        }
+    }
+    fprintf(h, "}\n");
+}
+
+// 输出压缩数据的符号声明：重复资源声明规范资源的压缩符号（分片中规范资源可能在别的头文件里）
+static void write_compressed_declarations(FILE *h, const ObjectFile *file)
+{
+    for (int a = 0; a < file->assetCount; a++)
+    {
+        const ObjectFile *target = file;
+        const Asset *canon = canonical_asset(&target, &file->assets[a]);
+        if (canon->packedSize > 0)
+            fprintf(h, "extern const unsigned char %s_lz4_start[];\n", canon->base);
+    }
+}
+
+// 输出 LZ4 块解码器；字典在逻辑上位于输出缓冲区之前
+static void write_lz4_decoder(FILE *h)
+{
+    fprintf(h, "#ifndef SG_LZ4_DECOMPRESS_DEFINED\n");
+    fprintf(h, "#define SG_LZ4_DECOMPRESS_DEFINED\n");
+    fprintf(h, "#include <stddef.h>\n");
+    fprintf(h, "#include <string.h>\n");
+    fprintf(h, "static inline size_t sg_lz4_decompress(const unsigned char *src, size_t srcSize, unsigned char *dst, size_t cap,\n");
+    fprintf(h, "                                       const unsigned char *dict, size_t dictSize)\n");
+    fprintf(h, "{\n");
+    fprintf(h, "    const unsigned char *ip = src;\n");
+    fprintf(h, "    const unsigned char *iend = src + srcSize;\n");
+    fprintf(h, "    size_t op = 0;\n");
+    fprintf(h, "    while (ip < iend)\n");
+    fprintf(h, "    {\n");
+    fprintf(h, "        unsigned token = *ip++;\n");
+    fprintf(h, "        size_t len = token >> 4;\n");
+    fprintf(h, "        if (len == 15)\n");
+    fprintf(h, "        {\n");
+    fprintf(h, "            unsigned b;\n");
+    fprintf(h, "            do\n");
+    fprintf(h, "            {\n");
+    fprintf(h, "                if (ip >= iend)\n");
+    fprintf(h, "                    return 0;\n");
+    fprintf(h, "                b = *ip++;\n");
+    fprintf(h, "                len += b;\n");
+    fprintf(h, "            } while (b == 255);\n");
+    fprintf(h, "        }\n");
+    fprintf(h, "        if ((size_t)(iend - ip) < len || cap - op < len)\n");
+    fprintf(h, "            return 0;\n");
+    fprintf(h, "        memcpy(dst + op, ip, len);\n");
+    fprintf(h, "        ip += len;\n");
+    fprintf(h, "        op += len;\n");
+    fprintf(h, "        if (ip == iend)\n");
+    fprintf(h, "            break;\n");
+    fprintf(h, "        if (iend - ip < 2)\n");
+    fprintf(h, "            return 0;\n");
+    fprintf(h, "        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);\n");
+    fprintf(h, "        ip += 2;\n");
+    fprintf(h, "        len = token & 15;\n");
+    fprintf(h, "        if (len == 15)\n");
+    fprintf(h, "        {\n");
+    fprintf(h, "            unsigned b;\n");
+    fprintf(h, "            do\n");
+    fprintf(h, "            {\n");
+    fprintf(h, "                if (ip >= iend)\n");
+    fprintf(h, "                    return 0;\n");
+    fprintf(h, "                b = *ip++;\n");
+    fprintf(h, "                len += b;\n");
+    fprintf(h, "            } while (b == 255);\n");
+    fprintf(h, "        }\n");
+    fprintf(h, "        len += 4;\n");
+    fprintf(h, "        if (offset == 0 || offset > op + dictSize || cap - op < len)\n");
+    fprintf(h, "            return 0;\n");
+    fprintf(h, "        for (; len > 0 && op < offset; len--, op++)\n");
+    fprintf(h, "            dst[op] = dict[dictSize + op - offset];\n");
+    fprintf(h, "        if (offset >= len)\n");
+    fprintf(h, "        {\n");
+    fprintf(h, "            memcpy(dst + op, dst + op - offset, len);\n");
+    fprintf(h, "            op += len;\n");
+    fprintf(h, "        }\n");
+    fprintf(h, "        else\n");
+    fprintf(h, "        {\n");
+    fprintf(h, "            for (; len > 0; len--, op++)\n");
+    fprintf(h, "                dst[op] = dst[op - offset];\n");
+    fprintf(h, "        }\n");
+    fprintf(h, "    }\n");
+    fprintf(h, "    return op;\n");
+    fprintf(h, "}\n");
+    fprintf(h, "#endif\n\n");
+}
+
+// 输出按需解压的访问函数
+static void write_decompress_accessors(FILE *h, const ObjectFile *files, int fileCount, const Options *opts)
+{
+    fprintf(h, "\n// LZ4-compressed payloads: <name>_decompress(dst, cap) returns the raw size, or 0 if cap is too small\n");
+    write_lz4_decoder(h);
+
+    char dict[320] = "NULL";
+    char dictSize[32] = "0";
+    if (opts->dictBase[0])
+    {
+        snprintf(dict, sizeof(dict), "%s_start", opts->dictBase);
+        snprintf(dictSize, sizeof(dictSize), "%u", opts->dictSize);
+    }
+
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            const Asset *asset = &files[f].assets[a];
+            const ObjectFile *target = &files[f];
+            const Asset *canon = canonical_asset(&target, asset);
+            uint64_t rawSize;
+            if (canon->packedSize == 0 || !asset_size(target, canon, &rawSize))
+                continue;
+
+            char upper[256];
+            char lower[256];
+            asset_ident(&files[f], a, upper, sizeof(upper));
+            snprintf(lower, sizeof(lower), "%s", upper);
+            to_uppercase(upper);
+            to_lowercase(lower);
+            fprintf(h, "#define %s_RAW_SIZE ((size_t)%llu)\n", upper, (unsigned long long)rawSize);
+            fprintf(h, "#define %s_LZ4_SIZE ((size_t)%llu)\n", upper, (unsigned long long)canon->packedSize);
+            fprintf(h, "static inline size_t %s_decompress(void *dst, size_t cap)\n", lower);
+            fprintf(h, "{\n");
+            fprintf(h, "    if (cap < %s_RAW_SIZE)\n", upper);
+            fprintf(h, "        return 0;\n");
+            if (canon->packedRaw)
+            {
+                fprintf(h, "    memcpy(dst, %s_lz4_start, %s_RAW_SIZE); // stored uncompressed\n", canon->base, upper);
+                fprintf(h, "    return %s_RAW_SIZE;\n", upper);
+            }
+            else
+            {
+                fprintf(h, "    return sg_lz4_decompress(%s_lz4_start, %s_LZ4_SIZE, (unsigned char *)dst, %s_RAW_SIZE, %s, %s) == %s_RAW_SIZE\n",
+                        canon->base, upper, upper, dict, dictSize, upper);
+                fprintf(h, "               ? %s_RAW_SIZE\n", upper);
+                fprintf(h, "               : 0;\n");
+            }
+            fprintf(h, "}\n");
+        }
+    }
+}
+
+// 输出差分存储的符号声明：差分资源同时声明其基准资源（基准可能在别的分片中）
+static void write_delta_declarations(FILE *h, const ObjectFile *file)
+{
+    for (int a = 0; a < file->assetCount; a++)
+    {
+        const ObjectFile *target = file;
+        const Asset *canon = canonical_asset(&target, &file->assets[a]);
+        if (canon->deltaKind == DELTA_NONE)
+            continue;
+        fprintf(h, "extern const unsigned char %s_delta_start[];\n", canon->base);
+        if (canon->deltaBaseFile)
+            fprintf(h, "extern const unsigned char %s_delta_start[];\n",
+                    canon->deltaBaseFile->assets[canon->deltaBaseAsset].base);
+    }
+}
+
+// 输出复制/插入差分的解码函数，格式见 delta_encode
+static void write_delta_decoder(FILE *h)
+{
+    fprintf(h, "#ifndef SG_DELTA_APPLY_DEFINED\n");
+    fprintf(h, "#define SG_DELTA_APPLY_DEFINED\n");
+    fprintf(h, "#include <stddef.h>\n");
+    fprintf(h, "#include <string.h>\n");
+    fprintf(h, "static inline int sg_delta_varint(const unsigned char **ip, const unsigned char *iend, size_t *out)\n");
+    fprintf(h, "{\n");
+    fprintf(h, "    size_t v = 0;\n");
+    fprintf(h, "    unsigned shift = 0;\n");
+    fprintf(h, "    for (;;)\n");
+    fprintf(h, "    {\n");
+    fprintf(h, "        if (*ip >= iend || shift >= sizeof(size_t) * 8)\n");
+    fprintf(h, "            return 0;\n");
+    fprintf(h, "        unsigned b = *(*ip)++;\n");
+    fprintf(h, "        v |= (size_t)(b & 0x7F) << shift;\n");
+    fprintf(h, "        if (!(b & 0x80))\n");
+    fprintf(h, "            break;\n");
+    fprintf(h, "        shift += 7;\n");
+    fprintf(h, "    }\n");
+    fprintf(h, "    *out = v;\n");
+    fprintf(h, "    return 1;\n");
+    fprintf(h, "}\n");
+    fprintf(h, "// Copy/insert delta: (literal length, literals, copy length, 32-bit base offset)..., ending with literals\n");
+    fprintf(h, "static inline size_t sg_delta_apply(const unsigned char *src, size_t srcSize, const unsigned char *base,\n");
+    fprintf(h, "                                    size_t baseSize, unsigned char *dst, size_t cap)\n");
+    fprintf(h, "{\n");
+    fprintf(h, "    const unsigned char *ip = src;\n");
+    fprintf(h, "    const unsigned char *iend = src + srcSize;\n");
+    fprintf(h, "    size_t op = 0;\n");
+    fprintf(h, "    size_t len;\n");
+    fprintf(h, "    while (ip < iend)\n");
+    fprintf(h, "    {\n");
+    fprintf(h, "        if (!sg_delta_varint(&ip, iend, &len) || (size_t)(iend - ip) < len || cap - op < len)\n");
+    fprintf(h, "            return 0;\n");
+    fprintf(h, "        memcpy(dst + op, ip, len);\n");
+    fprintf(h, "        ip += len;\n");
+    fprintf(h, "        op += len;\n");
+    fprintf(h, "        if (ip == iend)\n");
+    fprintf(h, "            break;\n");
+    fprintf(h, "        if (!sg_delta_varint(&ip, iend, &len) || iend - ip < 4)\n");
+    fprintf(h, "            return 0;\n");
+    fprintf(h, "        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8) | ((size_t)ip[2] << 16) | ((size_t)ip[3] << 24);\n");
+    fprintf(h, "        ip += 4;\n");
+    fprintf(h, "        if (offset > baseSize || len > baseSize - offset || cap - op < len)\n");
+    fprintf(h, "            return 0;\n");
+    fprintf(h, "        memcpy(dst + op, base + offset, len);\n");
+    fprintf(h, "        op += len;\n");
+    fprintf(h, "    }\n");
+    fprintf(h, "    return op;\n");
+    fprintf(h, "}\n");
+    fprintf(h, "#endif\n\n");
+}
+
+// 输出按需重建资源的访问函数：原样存放的直接复制，差分存放的从基准资源复制并插入字面量，独立压缩的用 LZ4 解码
+static void write_delta_accessors(FILE *h, const ObjectFile *files, int fileCount)
+{
+    fprintf(h, "\n// Delta-encoded payloads: <name>_reconstruct(dst, cap) returns the raw size, or 0 if cap is too small\n");
+    write_lz4_decoder(h);
+    write_delta_decoder(h);
+
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            const ObjectFile *target = &files[f];
+            const Asset *canon = canonical_asset(&target, &files[f].assets[a]);
+            uint64_t rawSize;
+            if (canon->deltaKind == DELTA_NONE || !asset_size(target, canon, &rawSize))
+                continue;
+
+            char upper[256];
+            char lower[256];
+            asset_ident(&files[f], a, upper, sizeof(upper));
+            snprintf(lower, sizeof(lower), "%s", upper);
+            to_uppercase(upper);
+            to_lowercase(lower);
+            fprintf(h, "#define %s_RAW_SIZE ((size_t)%llu)\n", upper, (unsigned long long)rawSize);
+            fprintf(h, "#define %s_DELTA_SIZE ((size_t)%llu)\n", upper, (unsigned long long)canon->deltaSize);
+            fprintf(h, "static inline size_t %s_reconstruct(void *dst, size_t cap)\n", lower);
+            fprintf(h, "{\n");
+            fprintf(h, "    if (cap < %s_RAW_SIZE)\n", upper);
+            fprintf(h, "        return 0;\n");
+            if (canon->deltaKind == DELTA_RAW)
+            {
+                fprintf(h, "    memcpy(dst, %s_delta_start, %s_RAW_SIZE);\n", canon->base, upper);
+                fprintf(h, "    return %s_RAW_SIZE;\n", upper);
+            }
+            else if (canon->deltaKind == DELTA_COPY)
+            {
+                const Asset *base = &canon->deltaBaseFile->assets[canon->deltaBaseAsset];
+                uint64_t baseSize = 0;
+                asset_size(canon->deltaBaseFile, base, &baseSize);
+                fprintf(h, "    return sg_delta_apply(%s_delta_start, %s_DELTA_SIZE, %s_delta_start, %llu, (unsigned char *)dst, %s_RAW_SIZE) == %s_RAW_SIZE\n",
+                        canon->base, upper, base->base, (unsigned long long)baseSize, upper, upper);
+                fprintf(h, "               ? %s_RAW_SIZE\n", upper);
+                fprintf(h, "               : 0;\n");
+            }
+            else
+            {
+                fprintf(h, "    return sg_lz4_decompress(%s_delta_start, %s_DELTA_SIZE, (unsigned char *)dst, %s_RAW_SIZE, NULL, 0) == %s_RAW_SIZE\n",
+                        canon->base, upper, upper, upper);
+                fprintf(h, "               ? %s_RAW_SIZE\n", upper);
+                fprintf(h, "               : 0;\n");
+            }
+            fprintf(h, "}\n");
+        }
+    }
+}
+
+// C++ 模式的头文件前导：标准库头文件与 extern "C" 块开始
+static void write_cpp_prologue(FILE *h)
+{
+    fprintf(h, "// Requires C++20 (<span>)\n");
+    fprintf(h, "#include <cstddef>\n");
+    fprintf(h, "#include <span>\n");
+    fprintf(h, "#include <string_view>\n\n");
+    fprintf(h, "extern \"C\"\n{\n");
+}
+
+// 排序键：按 --order-profile 中的位置，没有列出的 (-1) 转为无符号后排在最后，相同时保持原顺序
+typedef struct
+{
+    unsigned int rank;
+    int index;
+} RankKey;
+
+static int compare_rank_keys(const void *a, const void *b)
+{
+    const RankKey *x = a;
+    const RankKey *y = b;
+    if (x->rank != y->rank)
+        return x->rank < y->rank ? -1 : 1;
+    return x->index - y->index;
+}
+
+// 按访问顺序排列所有资源的全局下标，规范资源按它和所有重复资源中最早的访问顺序排列；
+// fileOf 记录每个全局下标所属的文件，firstAsset 记录每个文件第一个资源的全局下标
+static void rank_all_assets(const ObjectFile *files, int fileCount, RankKey *keys, int *fileOf, int *firstAsset)
+{
+    int total = 0;
+    for (int f = 0; f < fileCount; f++)
+    {
+        firstAsset[f] = total;
+        for (int a = 0; a < files[f].assetCount; a++, total++)
+        {
+            fileOf[total] = f;
+            keys[total].rank = (unsigned int)files[f].assets[a].rank;
+            keys[total].index = total;
+        }
+    }
+    for (int f = 0, n = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++, n++)
+        {
+            const Asset *asset = &files[f].assets[a];
+            if (!asset->aliasFile)
+                continue;
+            int canon = firstAsset[asset->aliasFile - files] + asset->aliasAsset;
+            if (keys[n].rank < keys[canon].rank)
+                keys[canon].rank = keys[n].rank;
+        }
+    }
+    qsort(keys, total, sizeof(RankKey), compare_rank_keys);
+}
+
+// 读取访问顺序文件：每行一个资源名（标识符或符号前缀，与 --hot 的匹配规则相同），# 开头的行为注释；
+// 资源的 rank 取第一次出现的行序号
+static int load_order_profile(const char *path, ObjectFile *files, int fileCount)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+    {
+        fprintf(stderr, "Error opening order profile '%s': %s\n", path, strerror(errno));
+        return 0;
+    }
+
+    char line[1024];
+    int rank = 0;
+    int matched = 0;
+    int ranked = 0;
+    while (fgets(line, sizeof(line), f))
+    {
+        char *name = line;
+        while (isspace((unsigned char)*name))
+            name++;
+        size_t len = strlen(name);
+        while (len > 0 && isspace((unsigned char)name[len - 1]))
+            name[--len] = '\0';
+        if (len == 0 || name[0] == '#')
+            continue;
+
+        int found = 0;
+        for (int g = 0; g < fileCount; g++)
+        {
+            for (int a = 0; a < files[g].assetCount; a++)
+            {
+                if (asset_in_list(&files[g], a, name))
+                {
+                    found = 1;
+                    if (files[g].assets[a].rank < 0)
+                    {
+                        files[g].assets[a].rank = rank;
+                        ranked++;
+                    }
+                }
+            }
+        }
+        if (!found)
+            fprintf(stderr, "Warning: profiled asset '%s' not found\n", name);
+        matched += found;
+        rank++;
+    }
+    fclose(f);
+    printf("Order profile: %d of %d entries matched, %d assets ordered\n", matched, rank, ranked);
+    return 1;
+}
+
+// 按资源的 rank 重排文件内的资源和符号（符号按资源分组，其余符号放在最后）
+static int order_file_assets(ObjectFile *file)
+{
+    int count = file->assetCount;
+    RankKey *keys = malloc((count ? count : 1) * sizeof(RankKey));
+    Asset *assets = malloc((count ? count : 1) * sizeof(Asset));
+    Symbol *symbols = malloc((file->symbolCount ? file->symbolCount : 1) * sizeof(Symbol));
+    int *newIndex = malloc((file->symbolCount ? file->symbolCount : 1) * sizeof(int));
+    if (!keys || !assets || !symbols || !newIndex)
+    {
+        fprintf(stderr, "Memory allocation failed for asset ordering\n");
+        free(keys);
+        free(assets);
+        free(symbols);
+        free(newIndex);
+        return 0;
+    }
+    for (int a = 0; a < count; a++)
+    {
+        keys[a].rank = (unsigned int)file->assets[a].rank;
+        keys[a].index = a;
+    }
+    qsort(keys, count, sizeof(RankKey), compare_rank_keys);
+
+    int used = 0;
+    for (int i = 0; i < file->symbolCount; i++)
+        newIndex[i] = -1;
+    for (int k = 0; k < count; k++)
+    {
+        assets[k] = file->assets[keys[k].index];
+        // 资源内的符号保持原来的相对顺序
+        for (int i = 0; i < file->symbolCount; i++)
+        {
+            if (i == assets[k].start || i == assets[k].end || i == assets[k].size)
+            {
+                newIndex[i] = used;
+                symbols[used++] = file->symbols[i];
+            }
+        }
+    }
+    for (int i = 0; i < file->symbolCount; i++)
+    {
+        if (newIndex[i] < 0)
+        {
+            newIndex[i] = used;
+            symbols[used++] = file->symbols[i];
+        }
+    }
+    for (int k = 0; k < count; k++)
+    {
+        assets[k].start = assets[k].start >= 0 ? newIndex[assets[k].start] : -1;
+        assets[k].end = assets[k].end >= 0 ? newIndex[assets[k].end] : -1;
+        assets[k].size = assets[k].size >= 0 ? newIndex[assets[k].size] : -1;
+    }
+
+    free(file->assets);
+    free(file->symbols);
+    file->assets = assets;
+    file->symbols = symbols;
+    free(keys);
+    free(newIndex);
+    return 1;
+}
+
+// 按访问顺序重排：文件按其中最早访问的资源排序，文件内的资源和符号按访问顺序排序；
+// 合并头文件、注册表、合并对象和链接脚本都按这个顺序输出，启动时一起访问的资源落在相同的页上
+static int order_assets_by_profile(const char *path, ObjectFile *files, int fileCount)
+{
+    if (!load_order_profile(path, files, fileCount))
+        return 0;
+
+    RankKey *keys = malloc(fileCount * sizeof(RankKey));
+    ObjectFile *sorted = malloc(fileCount * sizeof(ObjectFile));
+    if (!keys || !sorted)
+    {
+        fprintf(stderr, "Memory allocation failed for asset ordering\n");
+        free(keys);
+        free(sorted);
+        return 0;
+    }
+    int ok = 1;
+    for (int f = 0; f < fileCount; f++)
+    {
+        ok = ok && order_file_assets(&files[f]);
+        keys[f].rank = files[f].assetCount > 0 ? (unsigned int)files[f].assets[0].rank : (unsigned int)-1;
+        keys[f].index = f;
+    }
+    qsort(keys, fileCount, sizeof(RankKey), compare_rank_keys);
+    for (int f = 0; f < fileCount; f++)
+        sorted[f] = files[keys[f].index];
+    memcpy(files, sorted, fileCount * sizeof(ObjectFile));
+    free(keys);
+    free(sorted);
+    return ok;
+}
+
+// 跨文件查找内容完全相同的资源（先比较哈希，再逐字节确认），重复资源指向第一个出现的规范资源，
+// 返回节省的字节数
+static uint64_t dedup_assets(ObjectFile *files, int fileCount)
+{
+    int total = 0;
+    for (int f = 0; f < fileCount; f++)
+        total += files[f].assetCount;
+    if (total == 0)
+        return 0;
+
+    uint64_t *hashes = malloc(total * sizeof(uint64_t));
+    uint64_t *sizes = malloc(total * sizeof(uint64_t));
+    int *valid = malloc(total * sizeof(int));
+    if (!hashes || !sizes || !valid)
+    {
+        fprintf(stderr, "Memory allocation failed for dedup\n");
+        free(hashes);
+        free(sizes);
+        free(valid);
+        return 0;
+    }
+
+    // 第一遍：计算每个资源的哈希
+    int n = 0;
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++, n++)
+        {
+            unsigned char *data;
+            size_t size;
+            valid[n] = read_asset_payload(&files[f], &files[f].assets[a], &data, &size);
+            if (valid[n])
+            {
+                hashes[n] = xxh64(data, size, 0);
+                sizes[n] = size;
+                free(data);
+            }
+        }
+    }
+
+    // 第二遍：哈希相同的资源逐字节比较，确认后指向规范资源
+    uint64_t saved = 0;
+    int duplicates = 0;
+    n = 0;
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++, n++)
+        {
+            if (!valid[n])
+                continue;
+
+            int m = 0;
+            for (int g = 0; g <= f && !files[f].assets[a].aliasFile; g++)
+            {
+                for (int b = 0; b < files[g].assetCount && m < n; b++, m++)
+                {
+                    if (!valid[m] || files[g].assets[b].aliasFile || hashes[m] != hashes[n] || sizes[m] != sizes[n])
+                        continue;
+
+                    unsigned char *x;
+                    unsigned char *y;
+                    size_t xs;
+                    size_t ys;
+                    if (!read_asset_payload(&files[f], &files[f].assets[a], &x, &xs))
+                        continue;
+                    if (!read_asset_payload(&files[g], &files[g].assets[b], &y, &ys))
+                    {
+                        free(x);
+                        continue;
+                    }
+                    int same = xs == ys && memcmp(x, y, xs) == 0;
+                    free(x);
+                    free(y);
+                    if (!same)
+                        continue;
+
+                    files[f].assets[a].aliasFile = &files[g];
+                    files[f].assets[a].aliasAsset = b;
+                    saved += sizes[n];
+                    duplicates++;
+                    printf("Duplicate payload: %s (%s) -> %s (%s), %llu bytes\n", files[f].assets[a].base,
+                           files[f].filepath, files[g].assets[b].base, files[g].filepath, (unsigned long long)sizes[n]);
+                    break;
+                }
+            }
+        }
+    }
+
+    if (duplicates > 0)
+        printf("Dedup: %d duplicate payloads, %llu bytes saved\n", duplicates, (unsigned long long)saved);
+
+    free(hashes);
+    free(sizes);
+    free(valid);
+    return saved;
+}
+
+// 输出去重报告注释
+static void write_dedup_report(FILE *h, const ObjectFile *files, int fileCount, const Options *opts)
+{
+    int duplicates = 0;
+    uint64_t saved = 0;
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            const Asset *asset = &files[f].assets[a];
+            uint64_t size;
+            if (asset->aliasFile && asset_size(&files[f], asset, &size))
+            {
+                duplicates++;
+                saved += size;
+            }
+        }
+    }
+    if (duplicates == 0)
+        return;
+
+    fprintf(h, "// Duplicate payloads aliased to canonical symbols: %d, %llu bytes saved\n", duplicates,
+            (unsigned long long)saved);
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            const Asset *asset = &files[f].assets[a];
+            if (!asset->aliasFile)
+                continue;
+            char path[1024];
+            display_path(path, sizeof(path), files[f].filepath, opts);
+            fprintf(h, "//   %s (%s) -> %s\n", asset->base, path, asset->aliasFile->assets[asset->aliasAsset].base);
+        }
+    }
+    fprintf(h, "\n");
+}
+
+// 输出文件先写入临时文件，关闭时与已有文件比较，内容未变则保留原文件及其时间戳，避免触发无谓的重新编译
+static FILE *open_output(const char *path)
+{
+    char tmpPath[1100];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+    FILE *f = fopen(tmpPath, "wb");
+    if (!f)
+    {
+        fprintf(stderr, "Error creating file '%s': %s\n", tmpPath, strerror(errno));
+    }
+    return f;
+}
+
+// 比较两个文件内容是否完全相同
+static int files_equal(const char *a, const char *b)
+{
+    FILE *fa = fopen(a, "rb");
+    if (!fa)
+        return 0;
+    FILE *fb = fopen(b, "rb");
+    if (!fb)
+    {
+        fclose(fa);
+        return 0;
+    }
+
+    int equal = 1;
+    char bufA[4096];
+    char bufB[4096];
+    for (;;)
+    {
+        size_t na = fread(bufA, 1, sizeof(bufA), fa);
+        size_t nb = fread(bufB, 1, sizeof(bufB), fb);
+        if (na != nb || memcmp(bufA, bufB, na) != 0)
+        {
+            equal = 0;
+            break;
+        }
+        if (na == 0)
+            break;
+    }
+    fclose(fa);
+    fclose(fb);
+    return equal;
+}
+
+// 关闭 open_output 打开的文件并替换目标：返回 1 表示已更新，0 表示内容未变，-1 表示出错
+static int close_output(FILE *f, const char *path)
+{
+    char tmpPath[1100];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+    if (fclose(f) != 0)
+    {
+        fprintf(stderr, "Error writing file '%s': %s\n", tmpPath, strerror(errno));
+        remove(tmpPath);
+        return -1;
+    }
+
+    if (files_equal(tmpPath, path))
+    {
+        remove(tmpPath);
+        return 0;
+    }
+
+    // Windows 下 rename 不会覆盖已有文件
+    remove(path);
+    if (rename(tmpPath, path) != 0)
+    {
+        fprintf(stderr, "Error renaming '%s' to '%s': %s\n", tmpPath, path, strerror(errno));
+        remove(tmpPath);
+        return -1;
+    }
+    return 1;
+}
+
+// 报告头文件输出结果
+static void report_output(int status, const char *kind, const char *path)
+{
+    if (status > 0)
+        printf("Generated %s: %s\n", kind, path);
+    else if (status == 0)
+        printf("Unchanged %s: %s\n", kind, path);
+}
+
+// 拼接合并头文件路径，headerName 可以带或不带 .h 扩展名
+static void combined_header_path(char *out, size_t outSize, const char *outDir, const char *headerName)
+{
+    char normalizedDir[1024];
+
+    // 规范化输出目录
+    normalize_path(normalizedDir, sizeof(normalizedDir), outDir);
+
+    // 检查headerName是否已经以.h结尾
+    size_t nameLen = strlen(headerName);
+    int hasExtension = (nameLen >= 2 && strcmp(headerName + nameLen - 2, ".h") == 0);
+
+    // 统一使用正斜杠拼接路径
+    if (hasExtension)
+    {
+        snprintf(out, outSize, "%s/%s", normalizedDir, headerName);
+    }
+    else
+    {
+        snprintf(out, outSize, "%s/%s.h", normalizedDir, headerName);
+    }
+}
+
+// 由文件名生成保护宏名称：点号替换为下划线并转换为大写
+static void header_guard_name(char *out, size_t outSize, const char *name)
+{
+    strncpy(out, name, outSize - 1);
+    out[outSize - 1] = '\0';
+    for (char *p = out; *p; p++)
+    {
+        if (*p == '.')
+            *p = '_';
+    }
+    to_uppercase(out);
+}
+
+static void generate_header(const char *outDir, const char *baseName, const ObjectFile *file, const Options *opts)
+{
+    char headerPath[1024];
+    char normalizedDir[1024];
+    
+    // 规范化输出目录
+    normalize_path(normalizedDir, sizeof(normalizedDir), outDir);
+    
+    // 统一使用正斜杠拼接路径
+    snprintf(headerPath, sizeof(headerPath), "%s/%s.h", normalizedDir, baseName);
+
+    FILE *h = open_output(headerPath);
+    if (!h)
+        return;
+
+    // 创建清理后的宏名称（将点号替换为下划线）
+    char cleanName[256];
+    header_guard_name(cleanName, sizeof(cleanName), baseName);
+
+    fprintf(h, "// Auto-generated header from %s.o\n", baseName);
+    fprintf(h, "#ifndef _INCLUDE_%s_H_\n", cleanName);
+    fprintf(h, "#define _INCLUDE_%s_H_\n\n", cleanName);
+
+    if (opts->spirvAlign)
+        write_spirv_prologue(h);
+
+    if (opts->lang == LANG_CPP)
+        write_cpp_prologue(h);
+
+    write_declarations(h, file, opts);
+
+    if (opts->compress)
+        write_compressed_declarations(h, file);
+
+    if (opts->lang == LANG_CPP)
+        fprintf(h, "}\n");
+
+    const char *macro = file->macro;
+    if (macro && macro[0])
+    {
+        fprintf(h, "\n// Macros for convenience\n");
+        for (int i = 0; i < file->symbolCount; i++)
+        {
+            const char *name = file->symbols[i].name;
+            // 提取后缀
+            const char *suffix = strrchr(name, '_');
+            if (suffix)
+            {
+                suffix++; // 跳过下划线
+                char macroName[256];
+                snprintf(macroName, sizeof(macroName), "%s_%s", macro, suffix);
+                // 将宏名称转换为大写
+                to_uppercase(macroName);
+                fprintf(h, "#define %s %s\n", macroName, symbol_reference(file, i));
+            }
+        }
+    }
+
+    if (opts->spirvAlign)
+        write_spirv_macros(h, file, 1, opts);
+
+    if (opts->hash)
+        write_asset_hashes(h, file, 1);
+
+    if (opts->chunkSize)
+        write_chunk_tables(h, file, 1, opts);
+
+    if (opts->reflect)
+        write_spirv_reflection(h, file, 1);
+
+    if (opts->compress)
+        write_decompress_accessors(h, file, 1, opts);
+
+    if (opts->prefetch)
+        write_prefetch_helpers(h, cleanName, file, 1, opts);
+
+    if (opts->lang == LANG_CPP)
+        write_cpp_accessors(h, file, 1, opts);
+
+    fprintf(h, "\n#endif // _INCLUDE_%s_H_\n", cleanName);
+    report_output(close_output(h, headerPath), "header", headerPath);
+}
+
+static void generate_combined_header(const char *outDir, const char *headerName, const ObjectFile *files, int fileCount,
+                                     const Options *opts)
+{
+    char headerPath[1024];
+    combined_header_path(headerPath, sizeof(headerPath), outDir, headerName);
+
+    FILE *h = open_output(headerPath);
+    if (!h)
+        return;
+
+    // 清理头文件名用于宏定义
+    char cleanName[256];
+    header_guard_name(cleanName, sizeof(cleanName), headerName);
+
+    fprintf(h, "// Auto-generated combined header from %d object files\n", fileCount);
+    fprintf(h, "#ifndef _INCLUDE_%s_H_\n", cleanName);
+    fprintf(h, "#define _INCLUDE_%s_H_\n\n", cleanName);
+
+    if (opts->spirvAlign)
+        write_spirv_prologue(h);
+
+    if (opts->lang == LANG_CPP)
+        write_cpp_prologue(h);
+
+    // 输出所有符号
+    for (int f = 0; f < fileCount; f++)
+    {
+        if (files[f].symbolCount > 0)
+        {
+            // 规范化文件路径用于输出
+            char normalizedFilePath[1024];
+            display_path(normalizedFilePath, sizeof(normalizedFilePath), files[f].filepath, opts);
+            fprintf(h, "// From %s\n", normalizedFilePath);
+            write_declarations(h, &files[f], opts);
+            if (opts->compress)
+                write_compressed_declarations(h, &files[f]);
+            if (opts->delta)
+                write_delta_declarations(h, &files[f]);
+            fprintf(h, "\n");
+        }
+    }
+
+    if (opts->dedup)
+        write_external_canonical_declarations(h, files, fileCount, opts);
+
+    if (opts->compress && opts->dictBase[0])
+        fprintf(h, "// Shared LZ4 dictionary\nextern const unsigned char %s_start[];\n\n", opts->dictBase);
+
+    if (opts->lang == LANG_CPP)
+        fprintf(h, "}\n\n");
+
+    if (opts->dedup)
+        write_dedup_report(h, files, fileCount, opts);
+
+    // 输出宏定义（如果有）
+    int hasMacros = 0;
+    for (int f = 0; f < fileCount; f++)
+    {
+        if (files[f].macro && files[f].macro[0])
+        {
+            hasMacros = 1;
+            break;
+        }
+    }
+    if (hasMacros)
+    {
+        fprintf(h, "// Macros for convenience\n");
+        for (int f = 0; f < fileCount; f++)
+        {
+            if (files[f].macro && files[f].macro[0] && files[f].symbolCount > 0)
+            {
+                // 规范化文件路径用于输出
+                char normalizedFilePath[1024];
+                display_path(normalizedFilePath, sizeof(normalizedFilePath), files[f].filepath, opts);
+                fprintf(h, "// From %s\n", normalizedFilePath);
+                for (int i = 0; i < files[f].symbolCount; i++)
+                {
+                    const char *name = files[f].symbols[i].name;
+                    const char *suffix = strrchr(name, '_');
+                    if (suffix)
+                    {
+                        suffix++;
+                        char macroName[256];
+                        snprintf(macroName, sizeof(macroName), "%s_%s", files[f].macro, suffix);
+                        // 将宏名称转换为大写
+                        to_uppercase(macroName);
+                        fprintf(h, "#define %s %s\n", macroName, symbol_reference(&files[f], i));
+                    }
+                }
+            }
+        }
+    }
+
+    if (opts->spirvAlign)
+        write_spirv_macros(h, files, fileCount, opts);
+
+    if (opts->hash)
+        write_asset_hashes(h, files, fileCount);
+
+    if (opts->chunkSize)
+        write_chunk_tables(h, files, fileCount, opts);
+
+    if (opts->reflect)
+        write_spirv_reflection(h, files, fileCount);
+
+    if (opts->compress)
+        write_decompress_accessors(h, files, fileCount, opts);
+
+    if (opts->delta)
+        write_delta_accessors(h, files, fileCount);
+
+    if (opts->registry)
+        write_asset_registry(h, cleanName, files, fileCount, opts);
+
+    if (opts->xmacro)
+        write_asset_xmacro(h, cleanName, files, fileCount);
+
+    if (opts->pack)
+        write_pack_index(h, cleanName, files, fileCount, opts);
+
+    if (opts->lazy)
+        write_lazy_accessors(h, cleanName, files, fileCount, opts);
+
+    if (opts->prefetch)
+        write_prefetch_helpers(h, cleanName, files, fileCount, opts);
+
+    if (opts->lang == LANG_CPP)
+        write_cpp_accessors(h, files, fileCount, opts);
+
+    fprintf(h, "\n#endif // _INCLUDE_%s_H_\n", cleanName);
+    report_output(close_output(h, headerPath), "combined header", headerPath);
+}
+
+// 取头文件名去掉 .h 扩展名后的部分
+static void header_stem(char *out, size_t outSize, const char *headerName)
+{
+    snprintf(out, outSize, "%s", headerName);
+    size_t len = strlen(out);
+    if (len >= 2 && strcmp(out + len - 2, ".h") == 0)
+        out[len - 2] = '\0';
+}
+
+// 取对象文件所在目录（规范化后），没有目录部分时为 "."
+static void file_dir_key(char *out, size_t outSize, const char *filepath)
+{
+    normalize_path(out, outSize, filepath);
+    char *slash = strrchr(out, '/');
+    if (slash)
+        *slash = '\0';
+    else
+        snprintf(out, outSize, ".");
+}
+
+// 把目录转换为可用于文件名和宏名的标识符
+static void dir_to_ident(char *out, size_t outSize, const char *dir)
+{
+    while (*dir == '.' || *dir == '/')
+        dir++;
+    if (!*dir)
+        dir = "root";
+    snprintf(out, outSize, "%s", dir);
+    for (char *p = out; *p; p++)
+    {
+        if (!isalnum((unsigned char)*p))
+            *p = '_';
+    }
+}
+
+// 分片模式下在总头文件中输出 prefetch_all/preload_hot，依次调用各分片的同名函数
+static void write_umbrella_prefetch(FILE *h, const char *prefix, const ObjectFile *files, int fileCount,
+                                    const int *shardOf, char (*shardNames)[512], int shardCount,
+                                    const Options *opts)
+{
+    char lowerPrefix[256];
+    snprintf(lowerPrefix, sizeof(lowerPrefix), "%s", prefix);
+    to_lowercase(lowerPrefix);
+
+    // 只有包含 --hot 资源的分片才会输出 preload_hot
+    int *shardHot = calloc(shardCount, sizeof(int));
+    int anyHot = 0;
+    if (!shardHot)
+        return;
+    for (int f = 0; f < fileCount && opts->hotList; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            const Asset *asset = &files[f].assets[a];
+            if (asset->start >= 0 && asset->end >= 0 && asset_in_list(&files[f], a, opts->hotList))
+            {
+                shardHot[shardOf[f]] = 1;
+                anyHot = 1;
+            }
+        }
+    }
+
+    fprintf(h, "\n// Prefetch helpers spanning all shards\n");
+    fprintf(h, "static inline void %s_prefetch_all(void)\n", lowerPrefix);
+    fprintf(h, "{\n");
+    for (int s = 0; s < shardCount; s++)
+    {
+        char shardPrefix[512];
+        header_guard_name(shardPrefix, sizeof(shardPrefix), shardNames[s]);
+        to_lowercase(shardPrefix);
+        fprintf(h, "    %s_prefetch_all();\n", shardPrefix);
+    }
+    fprintf(h, "}\n");
+
+    if (anyHot)
+    {
+        fprintf(h, "static inline void %s_preload_hot(void)\n", lowerPrefix);
+        fprintf(h, "{\n");
+        for (int s = 0; s < shardCount; s++)
+        {
+            if (!shardHot[s])
+                continue;
+            char shardPrefix[512];
+            header_guard_name(shardPrefix, sizeof(shardPrefix), shardNames[s]);
+            to_lowercase(shardPrefix);
+            fprintf(h, "    %s_preload_hot();\n", shardPrefix);
+        }
+        fprintf(h, "}\n");
+    }
+    free(shardHot);
+}
+
+// 分片名是否已被前面的分片或索引头文件占用（不区分大小写）
+static int shard_name_taken(char (*shardNames)[512], int s, const char *stem)
+{
+    char indexName[300];
+    snprintf(indexName, sizeof(indexName), "%s_index", stem);
+    size_t len = strlen(shardNames[s]);
+    if (strlen(indexName) == len && ident_equal_nocase(indexName, shardNames[s], len))
+        return 1;
+    for (int t = 0; t < s; t++)
+    {
+        if (strlen(shardNames[t]) == len && ident_equal_nocase(shardNames[t], shardNames[s], len))
+            return 1;
+    }
+    return 0;
+}
+
+// 分片模式：按目录或按数量把合并头文件拆分为多个分片头文件，外加总头文件和索引头文件
+static void generate_sharded_headers(const char *outDir, const char *headerName, const ObjectFile *files, int fileCount,
+                                     const Options *opts)
+{
+    char stem[256];
+    header_stem(stem, sizeof(stem), headerName);
+
+    // 计算每个文件所属分片，分片按首次出现的顺序编号
+    int *shardOf = malloc(fileCount * sizeof(int));
+    char (*keys)[1024] = malloc(fileCount * sizeof(*keys));
+    ObjectFile *subset = malloc(fileCount * sizeof(ObjectFile));
+    if (!shardOf || !keys || !subset)
+    {
+        fprintf(stderr, "Memory allocation failed for shards\n");
+        free(shardOf);
+        free(keys);
+        free(subset);
+        return;
+    }
+
+    int shardCount = 0;
+    for (int f = 0; f < fileCount; f++)
+    {
+        char key[1024];
+        if (opts->shardBy == SHARD_BY_DIR)
+        {
+            char shown[1024];
+            display_path(shown, sizeof(shown), files[f].filepath, opts);
+            file_dir_key(key, sizeof(key), shown);
+        }
+        else
+            snprintf(key, sizeof(key), "%d", f / opts->shardCount);
+
+        int s = 0;
+        while (s < shardCount && strcmp(keys[s], key) != 0)
+            s++;
+        if (s == shardCount)
+        {
+            snprintf(keys[s], sizeof(keys[s]), "%s", key);
+            shardCount++;
+        }
+        shardOf[f] = s;
+    }
+
+    // 分片只包含声明、宏和 C++ 访问器，跨文件的注册表放在总头文件中
+    Options shardOpts = *opts;
+    shardOpts.registry = 0;
+    shardOpts.xmacro = 0;
+    shardOpts.pack = NULL;
+    shardOpts.lazy = 0;
+
+    char (*shardNames)[512] = malloc(shardCount * sizeof(*shardNames));
+    if (!shardNames)
+    {
+        fprintf(stderr, "Memory allocation failed for shards\n");
+        free(shardOf);
+        free(keys);
+        free(subset);
+        return;
+    }
+
+    for (int s = 0; s < shardCount; s++)
+    {
+        char ident[256];
+        if (opts->shardBy == SHARD_BY_DIR)
+            dir_to_ident(ident, sizeof(ident), keys[s]);
+        else
+            snprintf(ident, sizeof(ident), "%d", s);
+        snprintf(shardNames[s], sizeof(shardNames[s]), "%s_%s", stem, ident);
+
+        // 不同目录可能映射为同一个标识符（a-b 与 a_b、../x 与 x），头文件保护宏又不区分大小写，
+        // 冲突时追加序号，避免后一个分片覆盖前一个；<stem>_index 留给索引头文件
+        for (int suffix = 2; shard_name_taken(shardNames, s, stem); suffix++)
+            snprintf(shardNames[s], sizeof(shardNames[s]), "%s_%s_%d", stem, ident, suffix);
+        if (opts->shardBy == SHARD_BY_DIR && strcmp(shardNames[s] + strlen(stem) + 1, ident) != 0)
+        {
+            fprintf(stderr, "Warning: shard name for directory '%s' collides with another shard or the index header, using '%s'\n",
+                    keys[s], shardNames[s]);
+        }
+    }
+
+    for (int s = 0; s < shardCount; s++)
+    {
+        int n = 0;
+        for (int f = 0; f < fileCount; f++)
+        {
+            if (shardOf[f] == s)
+                subset[n++] = files[f];
+        }
+        generate_combined_header(outDir, shardNames[s], subset, n, &shardOpts);
+    }
+
+    // 总头文件：包含所有分片，并输出跨文件的注册表
+    char headerPath[1024];
+    char cleanName[256];
+    combined_header_path(headerPath, sizeof(headerPath), outDir, headerName);
+    header_guard_name(cleanName, sizeof(cleanName), stem);
+    FILE *h = open_output(headerPath);
+    if (h)
+    {
+        fprintf(h, "// Auto-generated umbrella header for %d shards\n", shardCount);
+        fprintf(h, "#ifndef _INCLUDE_%s_H_\n", cleanName);
+        fprintf(h, "#define _INCLUDE_%s_H_\n\n", cleanName);
+        for (int s = 0; s < shardCount; s++)
+        {
+            fprintf(h, "#include \"%s.h\"\n", shardNames[s]);
+        }
+        if (opts->registry)
+            write_asset_registry(h, cleanName, files, fileCount, opts);
+        if (opts->xmacro)
+            write_asset_xmacro(h, cleanName, files, fileCount);
+        if (opts->pack)
+            write_pack_index(h, cleanName, files, fileCount, opts);
+        if (opts->lazy)
+            write_lazy_accessors(h, cleanName, files, fileCount, opts);
+        if (opts->prefetch)
+            write_umbrella_prefetch(h, cleanName, files, fileCount, shardOf,
+                                    shardNames, shardCount, opts);
+        fprintf(h, "\n#endif // _INCLUDE_%s_H_\n", cleanName);
+        report_output(close_output(h, headerPath), "umbrella header", headerPath);
+    }
+
+    // 索引头文件：记录每个资源所在的分片，便于只包含需要的分片
+    char indexName[300];
+    char indexClean[300];
+    snprintf(indexName, sizeof(indexName), "%s_index.h", stem);
+    combined_header_path(headerPath, sizeof(headerPath), outDir, indexName);
+    header_guard_name(indexClean, sizeof(indexClean), indexName);
+    h = open_output(headerPath);
+    if (h)
+    {
+        fprintf(h, "// Auto-generated shard index for %s\n", headerName);
+        fprintf(h, "#ifndef _INCLUDE_%s_\n", indexClean);
+        fprintf(h, "#define _INCLUDE_%s_\n\n", indexClean);
+        fprintf(h, "#define %s_SHARD_COUNT %d\n\n", cleanName, shardCount);
+        for (int f = 0; f < fileCount; f++)
+        {
+            for (int a = 0; a < files[f].assetCount; a++)
+            {
+                char ident[256];
+                asset_ident(&files[f], a, ident, sizeof(ident));
+                to_uppercase(ident);
+                fprintf(h, "#define %s_HEADER \"%s.h\"\n", ident, shardNames[shardOf[f]]);
+            }
+        }
+        fprintf(h, "\n#endif // _INCLUDE_%s_\n", indexClean);
+        report_output(close_output(h, headerPath), "shard index", headerPath);
+    }
+
+    free(shardNames);
+    free(shardOf);
+    free(keys);
+    free(subset);
+}
+
+static int compare_symbols(const void *a, const void *b)
+{
+    return strcmp(((const Symbol *)a)->name, ((const Symbol *)b)->name);
+}
+
+static char *basename(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+    if (!slash)
+        slash = strrchr(path, '\\');
+    const char *start = slash ? slash + 1 : path;
+    char *base = my_strdup(start);
+    // 移除扩展名（对象文件的 .o/.obj，或原始文件的最后一个扩展名）
+    char *dot = strrchr(base, '.');
+    if (dot && dot != base)
+    {
+        *dot = '\0';
+    }
+    return base;
+}
+
+// 对象文件写出器：收集节和符号，一次写出与输入同格式的 ELF64 或 COFF 可重定位对象
+typedef struct
+{
+    char *name;
+    unsigned char *data;
+    uint32_t size;
+    uint32_t capacity;
+    uint32_t align;
+    int comdat; // COFF: IMAGE_SCN_LNK_COMDAT，节中第一个外部符号为 COMDAT 符号
+    int nobits; // 未初始化数据节（ELF SHT_NOBITS / COFF IMAGE_SCN_CNT_UNINITIALIZED_DATA），不写出数据
+} WriterSection;
+
+typedef struct
+{
+    char *name;
+    int section; // 节下标，-1 表示绝对符号
+    uint32_t value;
+} WriterSymbol;
+
+typedef struct
+{
+    int format;
+    uint16_t machine;
+    WriterSection *sections;
+    int sectionCount;
+    WriterSymbol *symbols;
+    int symbolCount;
+} ObjWriter;
+
+static void writer_init(ObjWriter *w, int format, uint16_t machine)
+{
+    memset(w, 0, sizeof(*w));
+    w->format = format;
+    w->machine = machine;
+}
+
+static void free_writer(ObjWriter *w)
+{
+    for (int s = 0; s < w->sectionCount; s++)
+    {
+        free(w->sections[s].name);
+        free(w->sections[s].data);
+    }
+    for (int i = 0; i < w->symbolCount; i++)
+    {
+        free(w->symbols[i].name);
+    }
+    free(w->sections);
+    free(w->symbols);
+    memset(w, 0, sizeof(*w));
+}
+
+// 添加节，返回节下标，失败返回 -1
+static int writer_add_section(ObjWriter *w, const char *name, uint32_t align)
+{
+    WriterSection *sections = realloc(w->sections, (w->sectionCount + 1) * sizeof(WriterSection));
+    if (!sections)
+    {
+        fprintf(stderr, "Memory allocation failed for output sections\n");
+        return -1;
+    }
+    w->sections = sections;
+    WriterSection *sec = &sections[w->sectionCount];
+    memset(sec, 0, sizeof(*sec));
+    sec->name = my_strdup(name);
+    sec->align = align ? align : 1;
+    return w->sectionCount++;
+}
+
+// 取资源数据应放入的节：--section-per-asset 时每个资源单独一节（ELF 为 <节名>.asset.<名称>，
+// COFF 为 COMDAT 节 <节名>$<名称>），链接器的 --gc-sections / /OPT:REF 可以丢弃没有被引用的资源；
+// 否则所有资源共用 *shared 节（首次使用时创建）
+static int writer_asset_section(ObjWriter *w, int *shared, const char *sectionName, const char *assetBase,
+                                uint32_t align, const Options *opts)
+{
+    if (!opts->sectionPerAsset)
+    {
+        if (*shared < 0)
+            *shared = writer_add_section(w, sectionName, align);
+        return *shared;
+    }
+
+    const char *name = strncmp(assetBase, "_binary_", 8) == 0 ? assetBase + 8 : assetBase;
+    char full[700];
+    if (w->format == FORMAT_COFF)
+        snprintf(full, sizeof(full), "%s$%s", sectionName, name);
+    else
+        snprintf(full, sizeof(full), "%s.asset.%s", sectionName, name);
+    int sec = writer_add_section(w, full, align);
+    if (sec >= 0)
+        w->sections[sec].comdat = w->format == FORMAT_COFF;
+    return sec;
+}
+
+// 向节末尾追加数据（先按 align 补零），返回数据在节内的偏移，失败返回 -1
+static int64_t writer_append(ObjWriter *w, int section, const void *data, size_t size, uint32_t align)
+{
+    WriterSection *sec = &w->sections[section];
+    uint64_t offset = align > 1 ? ((uint64_t)sec->size + align - 1) / align * align : sec->size;
+    if (offset + size > 0xFFFFFFFFu)
+    {
+        fprintf(stderr, "Section '%s' exceeds 4 GiB\n", sec->name);
+        return -1;
+    }
+    if (offset + size > sec->capacity)
+    {
+        uint64_t capacity = sec->capacity ? sec->capacity : 4096;
+        while (capacity < offset + size)
+            capacity *= 2;
+        if (capacity > 0xFFFFFFFFu)
+            capacity = offset + size;
+        unsigned char *grown = realloc(sec->data, capacity);
+        if (!grown)
+        {
+            fprintf(stderr, "Memory allocation failed for section '%s'\n", sec->name);
+            return -1;
+        }
+        sec->data = grown;
+        sec->capacity = (uint32_t)capacity;
+    }
+    memset(sec->data + sec->size, 0, offset - sec->size);
+    if (size > 0)
+        memcpy(sec->data + offset, data, size);
+    sec->size = (uint32_t)(offset + size);
+    if (align > sec->align)
+        sec->align = align;
+    return (int64_t)offset;
+}
+
+static int writer_add_symbol(ObjWriter *w, const char *name, int section, uint32_t value)
+{
+    WriterSymbol *symbols = realloc(w->symbols, (w->symbolCount + 1) * sizeof(WriterSymbol));
+    if (!symbols)
+    {
+        fprintf(stderr, "Memory allocation failed for output symbols\n");
+        return 0;
+    }
+    w->symbols = symbols;
+    symbols[w->symbolCount].name = my_strdup(name);
+    symbols[w->symbolCount].section = section;
+    symbols[w->symbolCount].value = value;
+    w->symbolCount++;
+    return 1;
+}
+
+// 补零使文件偏移对齐
+static void write_padding(FILE *f, long align)
+{
+    long pos = ftell(f);
+    while (align > 1 && pos % align != 0)
+    {
+        fputc(0, f);
+        pos++;
+    }
+}
+
+// 写出 ELF64 可重定位对象：用户节、.note.GNU-stack、.symtab、.strtab、.shstrtab，最后是节头表
+static void write_elf_object(FILE *f, const ObjWriter *w)
+{
+    int userCount = w->sectionCount;
+    int shnum = userCount + 5;
+    int noteIndex = userCount + 1;
+    int symtabIndex = userCount + 2;
+    int strtabIndex = userCount + 3;
+    int shstrtabIndex = userCount + 4;
+    Elf64_Shdr *shdrs = calloc(shnum, sizeof(Elf64_Shdr));
+
+    // 节名字符串表
+    size_t shstrSize = 1 + strlen(".note.GNU-stack") + 1 + strlen(".symtab") + 1 + strlen(".strtab") + 1 +
+                       strlen(".shstrtab") + 1;
+    for (int s = 0; s < userCount; s++)
+        shstrSize += strlen(w->sections[s].name) + 1;
+    char *shstrtab = calloc(shstrSize, 1);
+    size_t shstrUsed = 1;
+    for (int s = 0; s <= shnum - 1; s++)
+    {
+        const char *name = s == 0 ? NULL
+                           : s <= userCount      ? w->sections[s - 1].name
+                           : s == noteIndex      ? ".note.GNU-stack"
+                           : s == symtabIndex    ? ".symtab"
+                           : s == strtabIndex    ? ".strtab"
+                                                 : ".shstrtab";
+        if (!name)
+            continue;
+        shdrs[s].sh_name = (uint32_t)shstrUsed;
+        strcpy(shstrtab + shstrUsed, name);
+        shstrUsed += strlen(name) + 1;
+    }
+
+    // 符号字符串表
+    size_t strSize = 1;
+    for (int i = 0; i < w->symbolCount; i++)
+        strSize += strlen(w->symbols[i].name) + 1;
+    char *strtab = calloc(strSize, 1);
+
+    Elf64_Ehdr ehdr;
+    memset(&ehdr, 0, sizeof(ehdr));
+    ehdr.e_ident[0] = 0x7F;
+    ehdr.e_ident[1] = 'E';
+    ehdr.e_ident[2] = 'L';
+    ehdr.e_ident[3] = 'F';
+    ehdr.e_ident[4] = 2; // ELFCLASS64
+    ehdr.e_ident[5] = 1; // ELFDATA2LSB
+    ehdr.e_ident[6] = 1; // EV_CURRENT
+    ehdr.e_type = 1;     // ET_REL
+    ehdr.e_machine = w->machine;
+    ehdr.e_version = 1;
+    ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+    ehdr.e_shentsize = sizeof(Elf64_Shdr);
+    ehdr.e_shnum = (uint16_t)shnum;
+    ehdr.e_shstrndx = (uint16_t)shstrtabIndex;
+    fwrite(&ehdr, sizeof(ehdr), 1, f);
+
+    for (int s = 0; s < userCount; s++)
+    {
+        const WriterSection *sec = &w->sections[s];
+        write_padding(f, sec->nobits ? 1 : sec->align);
+        shdrs[s + 1].sh_type = sec->nobits ? 8 : 1;  // SHT_NOBITS / SHT_PROGBITS
+        shdrs[s + 1].sh_flags = sec->nobits ? 3 : 2; // SHF_WRITE | SHF_ALLOC / SHF_ALLOC
+        shdrs[s + 1].sh_offset = (uint64_t)ftell(f);
+        shdrs[s + 1].sh_size = sec->size;
+        shdrs[s + 1].sh_addralign = sec->align;
+        if (sec->size > 0 && !sec->nobits)
+            fwrite(sec->data, 1, sec->size, f);
+    }
+
+    shdrs[noteIndex].sh_type = 1;
+    shdrs[noteIndex].sh_offset = (uint64_t)ftell(f);
+    shdrs[noteIndex].sh_addralign = 1;
+
+    // 符号表：0 号为空符号，其余均为全局符号
+    write_padding(f, 8);
+    shdrs[symtabIndex].sh_type = 2; // SHT_SYMTAB
+    shdrs[symtabIndex].sh_offset = (uint64_t)ftell(f);
+    shdrs[symtabIndex].sh_size = (uint64_t)(w->symbolCount + 1) * sizeof(Elf64_Sym);
+    shdrs[symtabIndex].sh_link = (uint32_t)strtabIndex;
+    shdrs[symtabIndex].sh_info = 1; // 第一个非局部符号
+    shdrs[symtabIndex].sh_addralign = 8;
+    shdrs[symtabIndex].sh_entsize = sizeof(Elf64_Sym);
+    Elf64_Sym sym;
+    memset(&sym, 0, sizeof(sym));
+    fwrite(&sym, sizeof(sym), 1, f);
+    size_t strUsed = 1;
+    for (int i = 0; i < w->symbolCount; i++)
+    {
+        const WriterSymbol *ws = &w->symbols[i];
+        memset(&sym, 0, sizeof(sym));
+        sym.st_name = (uint32_t)strUsed;
+        strcpy(strtab + strUsed, ws->name);
+        strUsed += strlen(ws->name) + 1;
+        if (ws->section < 0)
+        {
+            sym.st_info = 0x10; // STB_GLOBAL | STT_NOTYPE
+            sym.st_shndx = 0xfff1; // SHN_ABS
+        }
+        else
+        {
+            sym.st_info = 0x11; // STB_GLOBAL | STT_OBJECT
+            sym.st_shndx = (uint16_t)(ws->section + 1);
+        }
+        sym.st_value = ws->value;
+        fwrite(&sym, sizeof(sym), 1, f);
+    }
+
+    shdrs[strtabIndex].sh_type = 3; // SHT_STRTAB
+    shdrs[strtabIndex].sh_offset = (uint64_t)ftell(f);
+    shdrs[strtabIndex].sh_size = strSize;
+    shdrs[strtabIndex].sh_addralign = 1;
+    fwrite(strtab, 1, strSize, f);
+
+    shdrs[shstrtabIndex].sh_type = 3;
+    shdrs[shstrtabIndex].sh_offset = (uint64_t)ftell(f);
+    shdrs[shstrtabIndex].sh_size = shstrSize;
+    shdrs[shstrtabIndex].sh_addralign = 1;
+    fwrite(shstrtab, 1, shstrSize, f);
+
+    write_padding(f, 8);
+    ehdr.e_shoff = (uint64_t)ftell(f);
+    fwrite(shdrs, sizeof(Elf64_Shdr), shnum, f);
+    fseek(f, 0, SEEK_SET);
+    fwrite(&ehdr, sizeof(ehdr), 1, f);
+    fseek(f, 0, SEEK_END);
+
+    free(strtab);
+    free(shstrtab);
+    free(shdrs);
+}
+
+// 计算对齐值对应的 COFF IMAGE_SCN_ALIGN_* 位（最大 8192 字节）
+static uint32_t coff_align_bits(uint32_t align)
+{
+    uint32_t bits = 1;
+    while (bits < 14 && (1u << (bits - 1)) < align)
+        bits++;
+    return bits << 20;
+}
+
+// COFF 名称：不超过 8 字节的直接存放，否则写入字符串表（节名用 "/偏移"）
+static void coff_name(char out[8], const char *name, int isSection, char *strTable, uint32_t *strUsed)
+{
+    memset(out, 0, 8);
+    size_t len = strlen(name);
+    if (len <= 8)
+    {
+        memcpy(out, name, len);
+        return;
+    }
+    if (isSection)
+    {
+        char ref[16];
+        snprintf(ref, sizeof(ref), "/%u", *strUsed);
+        memcpy(out, ref, strlen(ref));
+    }
+    else
+    {
+        uint32_t offset = *strUsed;
+        memcpy(out + 4, &offset, 4);
+    }
+    strcpy(strTable + *strUsed, name);
+    *strUsed += (uint32_t)len + 1;
+}
+
+// 写出 COFF 可重定位对象：文件头、节头、节数据、符号表和字符串表
+static void write_coff_object(FILE *f, const ObjWriter *w)
+{
+    // 节名可能同时出现在节头和 COMDAT 节符号中
+    uint32_t strSize = 4;
+    uint32_t symbolCount = (uint32_t)w->symbolCount;
+    for (int s = 0; s < w->sectionCount; s++)
+    {
+        strSize += 2 * ((uint32_t)strlen(w->sections[s].name) + 1);
+        if (w->sections[s].comdat)
+            symbolCount += 2;
+    }
+    for (int i = 0; i < w->symbolCount; i++)
+        strSize += (uint32_t)strlen(w->symbols[i].name) + 1;
+    char *strTable = calloc(strSize, 1);
+    uint32_t strUsed = 4;
+
+    COFF_HEADER hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.Machine = w->machine;
+    hdr.NumberOfSections = (uint16_t)w->sectionCount;
+    hdr.NumberOfSymbols = symbolCount;
+    fwrite(&hdr, sizeof(hdr), 1, f);
+
+    COFF_SECTION *secs = calloc(w->sectionCount ? w->sectionCount : 1, sizeof(COFF_SECTION));
+    fwrite(secs, sizeof(COFF_SECTION), w->sectionCount, f);
+    for (int s = 0; s < w->sectionCount; s++)
+    {
+        const WriterSection *sec = &w->sections[s];
+        coff_name(secs[s].Name, sec->name, 1, strTable, &strUsed);
+        // IMAGE_SCN_CNT_INITIALIZED_DATA | IMAGE_SCN_MEM_READ，未初始化数据为
+        // IMAGE_SCN_CNT_UNINITIALIZED_DATA | IMAGE_SCN_MEM_READ | IMAGE_SCN_MEM_WRITE
+        secs[s].Characteristics = (sec->nobits ? 0xC0000080 : 0x40000040) | coff_align_bits(sec->align);
+        if (sec->comdat)
+            secs[s].Characteristics |= 0x00001000; // IMAGE_SCN_LNK_COMDAT
+        secs[s].SizeOfRawData = sec->size;
+        if (sec->size > 0 && !sec->nobits)
+        {
+            write_padding(f, 16);
+            secs[s].PointerToRawData = (uint32_t)ftell(f);
+            fwrite(sec->data, 1, sec->size, f);
+        }
+    }
+
+    write_padding(f, 4);
+    hdr.PointerToSymbolTable = (uint32_t)ftell(f);
+    // 符号按节分组输出，绝对符号放在最后；COMDAT 节先输出节符号和节定义辅助记录，
+    // 紧随其后的第一个外部符号即为该节的 COMDAT 符号
+    for (int s = 0; s <= w->sectionCount; s++)
+    {
+        int section = s < w->sectionCount ? s : -1;
+        if (section >= 0 && w->sections[section].comdat)
+        {
+            COFF_SYMBOL sym;
+            memset(&sym, 0, sizeof(sym));
+            coff_name(sym.Name.Name, w->sections[section].name, 0, strTable, &strUsed);
+            sym.SectionNumber = (int16_t)(section + 1);
+            sym.StorageClass = 3; // IMAGE_SYM_CLASS_STATIC
+            sym.NumberOfAuxSymbols = 1;
+            fwrite(&sym, 18, 1, f);
+
+            unsigned char aux[18];
+            memset(aux, 0, sizeof(aux));
+            memcpy(aux, &w->sections[section].size, 4); // Length
+            aux[14] = 1;                                 // IMAGE_COMDAT_SELECT_NODUPLICATES
+            fwrite(aux, 18, 1, f);
+        }
+
+        for (int i = 0; i < w->symbolCount; i++)
+        {
+            const WriterSymbol *ws = &w->symbols[i];
+            if (ws->section != section)
+                continue;
+            COFF_SYMBOL sym;
+            memset(&sym, 0, sizeof(sym));
+            coff_name(sym.Name.Name, ws->name, 0, strTable, &strUsed);
+            sym.Value = ws->value;
+            sym.SectionNumber = ws->section < 0 ? -1 : (int16_t)(ws->section + 1);
+            sym.StorageClass = 2; // IMAGE_SYM_CLASS_EXTERNAL
+            fwrite(&sym, 18, 1, f);
+        }
+    }
+    memcpy(strTable, &strUsed, 4);
+    fwrite(strTable, 1, strUsed, f);
+
+    fseek(f, 0, SEEK_SET);
+    fwrite(&hdr, sizeof(hdr), 1, f);
+    fwrite(secs, sizeof(COFF_SECTION), w->sectionCount, f);
+    fseek(f, 0, SEEK_END);
+
+    free(secs);
+    free(strTable);
+}
+
+// 写出对象文件（内容未变时保留原文件）
+static int save_object(const ObjWriter *w, const char *path)
+{
+    FILE *f = open_output(path);
+    if (!f)
+        return 0;
+    if (w->format == FORMAT_COFF)
+        write_coff_object(f, w);
+    else
+        write_elf_object(f, w);
+    int status = close_output(f, path);
+    report_output(status, "object", path);
+    return status >= 0;
+}
+
+// 写出只包含资源数据的对象文件：每个资源生成 <base>_start/_end/_size 符号，与 ld -r -b binary 的命名一致；
+// 节名和对齐由 --section/--align 指定，--zero-bss 时全零的资源放入 .bss
+static int emit_asset_object(const char *path, int format, uint16_t machine, char *const *bases,
+                             unsigned char *const *payloads, const size_t *sizes, int count, const Options *opts)
+{
+    const char *sectionName = opts->assetSection ? opts->assetSection : format == FORMAT_COFF ? ".rdata" : ".rodata";
+    // SPIR-V 模式下头文件承诺的对齐大于 --align 时按前者对齐
+    uint32_t align = opts->assetAlign;
+    if ((uint32_t)opts->spirvAlign > align)
+        align = (uint32_t)opts->spirvAlign;
+    ObjWriter w;
+    writer_init(&w, format, machine);
+    int shared = -1;
+    int sharedBss = -1;
+    int ok = 1;
+    for (int i = 0; i < count && ok; i++)
+    {
+        char name[600];
+        int zero = opts->zeroBss && sizes[i] > 0 && is_all_zero(payloads[i], sizes[i]);
+        int sec = zero ? writer_asset_section(&w, &sharedBss, ".bss", bases[i], align, opts)
+                       : writer_asset_section(&w, &shared, sectionName, bases[i], align, opts);
+        if (sec < 0)
+        {
+            ok = 0;
+            break;
+        }
+        if (zero)
+        {
+            w.sections[sec].nobits = 1;
+            printf("Emitting zero-filled '%s' as uninitialized data (%zu bytes)\n", bases[i], sizes[i]);
+        }
+        int64_t offset = writer_append(&w, sec, payloads[i], sizes[i], align);
+        snprintf(name, sizeof(name), "%s_start", bases[i]);
+        ok = offset >= 0 && writer_add_symbol(&w, name, sec, (uint32_t)offset);
+        snprintf(name, sizeof(name), "%s_end", bases[i]);
+        ok = ok && writer_add_symbol(&w, name, sec, (uint32_t)(offset + sizes[i]));
+        snprintf(name, sizeof(name), "%s_size", bases[i]);
+        ok = ok && writer_add_symbol(&w, name, -1, (uint32_t)sizes[i]);
+    }
+    ok = ok && save_object(&w, path);
+    free_writer(&w);
+    return ok;
+}
+
+// 判断输入是否为原始文件：按文件头而不是扩展名判断，ELF 魔数或合理的 COFF 文件头（已知的机器类型、
+// 没有可选头、节数和符号表位置都在文件范围内）按对象文件解析，其余都按原始数据嵌入；
+// 无法读取时交给对象解析报告错误
+static int is_raw_input(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return 0;
+    COFF_HEADER hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    size_t got = fread(&hdr, 1, sizeof(hdr), f);
+    long fileSize = fseek(f, 0, SEEK_END) == 0 ? ftell(f) : -1;
+    fclose(f);
+
+    const unsigned char *magic = (const unsigned char *)&hdr;
+    if (got >= 4 && magic[0] == 0x7F && magic[1] == 'E' && magic[2] == 'L' && magic[3] == 'F')
+        return 0;
+    if (got < sizeof(hdr) || fileSize < 0)
+        return 1;
+    switch (hdr.Machine)
+    {
+    case 0x0000: // IMAGE_FILE_MACHINE_UNKNOWN（与机器无关的对象）
+    case 0x014C: // IMAGE_FILE_MACHINE_I386
+    case 0x8664: // IMAGE_FILE_MACHINE_AMD64
+    case 0x01C0: // IMAGE_FILE_MACHINE_ARM
+    case 0x01C4: // IMAGE_FILE_MACHINE_ARMNT
+    case 0xAA64: // IMAGE_FILE_MACHINE_ARM64
+    case 0xA641: // IMAGE_FILE_MACHINE_ARM64EC
+    case 0x5064: // IMAGE_FILE_MACHINE_RISCV64
+        break;
+    default:
+        return 1;
+    }
+    uint64_t headers = sizeof(COFF_HEADER) + (uint64_t)hdr.NumberOfSections * sizeof(COFF_SECTION);
+    uint64_t symbolsEnd = (uint64_t)hdr.PointerToSymbolTable + (uint64_t)hdr.NumberOfSymbols * 18;
+    return hdr.SizeOfOptionalHeader != 0 || hdr.NumberOfSections == 0 || headers > (uint64_t)fileSize ||
+           hdr.PointerToSymbolTable < headers || symbolsEnd > (uint64_t)fileSize;
+}
+
+// 原始文件生成的对象文件路径：<outDir>/<去掉最后一个扩展名的文件名>.o
+static void raw_object_path(char *out, size_t outSize, const char *outDir, const char *rawPath)
+{
+    char normalizedDir[1024];
+    normalize_path(normalizedDir, sizeof(normalizedDir), outDir);
+    char *base = basename(rawPath);
+    snprintf(out, outSize, "%s/%s.o", normalizedDir, base ? base : "asset");
+    free(base);
+}
+
+// 编译本工具的平台对应的机器类型，用于原始文件生成的对象
+static uint16_t host_machine(int format)
+{
+#if defined(__aarch64__) || defined(_M_ARM64)
+    return format == FORMAT_COFF ? 0xAA64 : 183; // IMAGE_FILE_MACHINE_ARM64 / EM_AARCH64
+#elif defined(__riscv)
+    return format == FORMAT_COFF ? 0x5064 : 243; // IMAGE_FILE_MACHINE_RISCV64 / EM_RISCV
+#else
+    return format == FORMAT_COFF ? 0x8664 : 62; // IMAGE_FILE_MACHINE_AMD64 / EM_X86_64
+#endif
+}
+
+// 把原始文件嵌入为对象文件，符号名与 ld -r -b binary 相同：_binary_ 加上路径中非字母数字字符替换为下划线
+// （路径按 --prefix-map/--deterministic 处理后再转换）
+static int build_raw_object(const char *rawPath, const char *objPath, const Options *opts)
+{
+    FILE *f = fopen(rawPath, "rb");
+    if (!f)
+    {
+        fprintf(stderr, "Error opening file '%s': %s\n", rawPath, strerror(errno));
+        return 0;
+    }
+    fseek(f, 0, SEEK_END);
+    long fileSize = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    unsigned char *data = malloc(fileSize > 0 ? (size_t)fileSize : 1);
+    if (!data || fileSize < 0 || fread(data, 1, (size_t)fileSize, f) != (size_t)fileSize)
+    {
+        fprintf(stderr, "Error reading file '%s'\n", rawPath);
+        free(data);
+        fclose(f);
+        return 0;
+    }
+    fclose(f);
+
+    char shown[1024];
+    char symbol[1100];
+    display_path(shown, sizeof(shown), rawPath, opts);
+    snprintf(symbol, sizeof(symbol), "_binary_%s", shown);
+    for (char *p = symbol + 8; *p; p++)
+    {
+        if (!isalnum((unsigned char)*p))
+            *p = '_';
+    }
+
+    char *bases[1] = {symbol};
+    size_t sizes[1] = {(size_t)fileSize};
+    int ok = emit_asset_object(objPath, opts->rawFormat, host_machine(opts->rawFormat), bases, &data, sizes, 1, opts);
+    free(data);
+    return ok;
+}
+
+// 重新解析改写后的对象文件，替换原有的符号、节和资源信息
+static int reload_object(ObjectFile *file, const char *path, const Options *opts)
+{
+    free_symbols(file->symbols, file->symbolCount);
+    free_assets(file->assets, file->assetCount);
+    free_sections(file->sections, file->sectionCount);
+    file->symbols = NULL;
+    file->symbolCount = 0;
+    file->assets = NULL;
+    file->assetCount = 0;
+    file->sections = NULL;
+    file->sectionCount = 0;
+
+    char *copy = my_strdup(path);
+    if (!copy)
+        return 0;
+    free(file->filepath);
+    file->filepath = copy;
+
+    if (!parse_object_file(path, file))
+        return 0;
+    if (opts->deterministic)
+        qsort(file->symbols, file->symbolCount, sizeof(Symbol), compare_symbols);
+    return collect_assets(file);
+}
+
+// 改写对象的输出路径：<outDir>/<name>.<suffix>.o
+static void rewritten_object_path(char *out, size_t outSize, const char *outDir, const ObjectFile *file,
+                                  const char *suffix)
+{
+    char normalizedDir[1024];
+    char *base = basename(file->inputPath);
+    normalize_path(normalizedDir, sizeof(normalizedDir), outDir);
+    snprintf(out, outSize, "%s/%s.%s.o", normalizedDir, base ? base : "asset", suffix);
+    free(base);
+}
+
+// 剥离对象中 SPIR-V 资源的调试指令，以相同的符号名写出 <outDir>/<name>.stripped.o，
+// 之后的哈希、反射、压缩和头文件都基于剥离后的对象
+static int strip_spirv_assets(const char *outDir, ObjectFile *file, const Options *opts)
+{
+    int count = file->assetCount;
+    char **bases = calloc(count ? count : 1, sizeof(char *));
+    unsigned char **payloads = calloc(count ? count : 1, sizeof(unsigned char *));
+    size_t *sizes = calloc(count ? count : 1, sizeof(size_t));
+    if (!bases || !payloads || !sizes)
+    {
+        fprintf(stderr, "Memory allocation failed for SPIR-V stripping\n");
+        free(bases);
+        free(payloads);
+        free(sizes);
+        return 0;
+    }
+
+    int ok = 1;
+    int kept = 0;
+    size_t before = 0;
+    size_t after = 0;
+    for (int a = 0; a < count && ok; a++)
+    {
+        // 没有数据的资源（例如只有 _size 符号）无法改写
+        if (!read_asset_payload(file, &file->assets[a], &payloads[kept], &sizes[kept]))
+        {
+            fprintf(stderr, "Cannot read payload of '%s' for stripping\n", file->assets[a].base);
+            ok = 0;
+            break;
+        }
+        bases[kept] = file->assets[a].base;
+        before += sizes[kept];
+        sizes[kept] = strip_spirv_debug(payloads[kept], sizes[kept]);
+        after += sizes[kept];
+        kept++;
+    }
+
+    if (ok)
+    {
+        char path[1400];
+        rewritten_object_path(path, sizeof(path), outDir, file, "stripped");
+        printf("Stripped %zu bytes of SPIR-V debug info from '%s'\n", before - after, file->filepath);
+        ok = emit_asset_object(path, file->format, file->machine, bases, payloads, sizes, kept, opts);
+        // bases 指向旧资源，重新解析前先写出
+        ok = ok && reload_object(file, path, opts);
+    }
+
+    for (int i = 0; i < kept; i++)
+        free(payloads[i]);
+    free(bases);
+    free(payloads);
+    free(sizes);
+    return ok;
+}
+
+// 对象文件的内存映像：原地修改节头和节标志，新的字符串表追加到文件末尾，其余数据的偏移保持不变
+typedef struct
+{
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+} ObjImage;
+
+static int load_image(ObjImage *img, const char *path)
+{
+    memset(img, 0, sizeof(*img));
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        fprintf(stderr, "Error opening file '%s': %s\n", path, strerror(errno));
+        return 0;
+    }
+    fseek(f, 0, SEEK_END);
+    long fileSize = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    img->data = malloc(fileSize > 0 ? (size_t)fileSize : 1);
+    if (!img->data || fileSize < 0 || fread(img->data, 1, (size_t)fileSize, f) != (size_t)fileSize)
+    {
+        fprintf(stderr, "Error reading file '%s'\n", path);
+        free(img->data);
+        img->data = NULL;
+        fclose(f);
+        return 0;
+    }
+    fclose(f);
+    img->size = (size_t)fileSize;
+    img->capacity = img->size;
+    return 1;
+}
+
+static void free_image(ObjImage *img)
+{
+    free(img->data);
+    memset(img, 0, sizeof(*img));
+}
+
+// 在映像末尾追加数据（先按 align 补零），返回数据在文件中的偏移，失败返回 -1
+static int64_t image_append(ObjImage *img, const void *data, size_t size, uint32_t align)
+{
+    size_t offset = align > 1 ? (img->size + align - 1) / align * align : img->size;
+    if (offset + size > 0xFFFFFFFFu)
+    {
+        fprintf(stderr, "Rewritten object exceeds 4 GiB\n");
+        return -1;
+    }
+    if (offset + size > img->capacity)
+    {
+        size_t capacity = img->capacity ? img->capacity : 4096;
+        while (capacity < offset + size)
+            capacity *= 2;
+        unsigned char *grown = realloc(img->data, capacity);
+        if (!grown)
+        {
+            fprintf(stderr, "Memory allocation failed for rewritten object\n");
+            return -1;
+        }
+        img->data = grown;
+        img->capacity = capacity;
+    }
+    memset(img->data + img->size, 0, offset - img->size);
+    if (size > 0)
+        memcpy(img->data + offset, data, size);
+    img->size = offset + size;
+    return (int64_t)offset;
+}
+
+static int save_image(const ObjImage *img, const char *path)
+{
+    FILE *f = open_output(path);
+    if (!f)
+        return 0;
+    fwrite(img->data, 1, img->size, f);
+    int status = close_output(f, path);
+    report_output(status, "object", path);
+    return status >= 0;
+}
+
+// 标记资源数据所在的节（按 file->sections 下标），返回标记的节数
+static int mark_asset_sections(const ObjectFile *file, unsigned char *marked)
+{
+    int count = 0;
+    memset(marked, 0, file->sectionCount ? file->sectionCount : 1);
+    for (int a = 0; a < file->assetCount; a++)
+    {
+        const Asset *asset = &file->assets[a];
+        int ends[2] = {asset->start, asset->end};
+        for (int k = 0; k < 2; k++)
+        {
+            const Section *sec = ends[k] >= 0 ? symbol_section(file, &file->symbols[ends[k]]) : NULL;
+            if (sec && !marked[sec - file->sections])
+            {
+                marked[sec - file->sections] = 1;
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+// 替换节名前缀：name 为 prefix 或 prefix.xxx / prefix$xxx 时改为 replacement 并保留后缀，否则返回 0
+static int replace_section_prefix(char *out, size_t outSize, const char *name, const char *prefix,
+                                  const char *replacement)
+{
+    size_t len = strlen(prefix);
+    if (strncmp(name, prefix, len) != 0 || (name[len] && name[len] != '.' && name[len] != '$'))
+        return 0;
+    snprintf(out, outSize, "%s%s", replacement, name + len);
+    return 1;
+}
+
+// 可写数据节改名为只读数据节：.data -> .rodata（COFF 为 .rdata）；其它节名保持不变，返回 0
+static int rodata_section_name(char *out, size_t outSize, const char *name, int format)
+{
+    return replace_section_prefix(out, outSize, name, ".data", format == FORMAT_COFF ? ".rdata" : ".rodata");
+}
+
+// 全零的数据节改名为未初始化数据节：.data / .rodata / .rdata -> .bss；其它节名保持不变，返回 0
+static int bss_section_name(char *out, size_t outSize, const char *name)
+{
+    return replace_section_prefix(out, outSize, name, ".data", ".bss") ||
+           replace_section_prefix(out, outSize, name, ".rodata", ".bss") ||
+           replace_section_prefix(out, outSize, name, ".rdata", ".bss");
+}
+
+// 向节头字符串表副本追加名称，返回名称的偏移，失败返回 -1
+static int64_t elf_add_name(char **table, size_t *size, size_t *capacity, const char *name)
+{
+    size_t len = strlen(name) + 1;
+    if (*size + len > *capacity)
+    {
+        size_t grownCapacity = (*size + len) * 2;
+        char *grown = realloc(*table, grownCapacity);
+        if (!grown)
+        {
+            fprintf(stderr, "Memory allocation failed for section header string table\n");
+            return -1;
+        }
+        *table = grown;
+        *capacity = grownCapacity;
+    }
+    memcpy(*table + *size, name, len);
+    *size += len;
+    return (int64_t)(*size - len);
+}
+
+// ELF：按选项修改资源所在节的节头（全零转为 NOBITS、对齐、只读），
+// 新节名追加到节头字符串表的副本，副本写到文件末尾
+static int patch_elf_sections(ObjImage *img, const ObjectFile *file, const unsigned char *marked, const Options *opts,
+                              int *changed)
+{
+    Elf64_Ehdr ehdr;
+    memcpy(&ehdr, img->data, sizeof(ehdr));
+    if (ehdr.e_shoff + (uint64_t)ehdr.e_shnum * sizeof(Elf64_Shdr) > img->size || ehdr.e_shstrndx >= ehdr.e_shnum)
+    {
+        fprintf(stderr, "Invalid section header table in '%s'\n", file->filepath);
+        return 0;
+    }
+    Elf64_Shdr *shdrs = malloc(ehdr.e_shnum * sizeof(Elf64_Shdr));
+    if (!shdrs)
+    {
+        fprintf(stderr, "Memory allocation failed for section headers\n");
+        return 0;
+    }
+    memcpy(shdrs, img->data + ehdr.e_shoff, ehdr.e_shnum * sizeof(Elf64_Shdr));
+
+    Elf64_Shdr *strHdr = &shdrs[ehdr.e_shstrndx];
+    size_t strSize = (size_t)strHdr->sh_size;
+    size_t strCapacity = strSize + 256;
+    char *shstrtab = strHdr->sh_offset + strSize <= img->size ? malloc(strCapacity) : NULL;
+    if (!shstrtab)
+    {
+        fprintf(stderr, "Invalid section header string table in '%s'\n", file->filepath);
+        free(shdrs);
+        return 0;
+    }
+    memcpy(shstrtab, img->data + strHdr->sh_offset, strSize);
+
+    int ok = 1;
+    int renamed = 0;
+    for (int s = 0; s < ehdr.e_shnum && s < file->sectionCount && ok; s++)
+    {
+        if (!marked[s])
+            continue;
+        const char *oldName = file->sections[s].name;
+        if (opts->realign && shdrs[s].sh_addralign < opts->realign)
+        {
+            printf("Aligned section '%s' of '%s' to %u bytes (was %llu)\n", oldName, file->filepath, opts->realign,
+                   (unsigned long long)shdrs[s].sh_addralign);
+            shdrs[s].sh_addralign = opts->realign;
+            (*changed)++;
+        }
+        if ((!opts->rewriteRodata && !opts->zeroBss) || shdrs[s].sh_type == 8) // SHT_NOBITS
+            continue;
+
+        // 有重定位的节不能去掉数据，改为只读后会在位置无关的可执行文件中产生文本重定位，保持原样
+        int relocated = 0;
+        for (int r = 0; r < ehdr.e_shnum; r++)
+            relocated |= (shdrs[r].sh_type == 4 || shdrs[r].sh_type == 9) && shdrs[r].sh_info == (uint32_t)s;
+        if (relocated)
+        {
+            fprintf(stderr, "Warning: section '%s' in '%s' has relocations, left unchanged\n", oldName,
+                    file->filepath);
+            continue;
+        }
+
+        char name[600];
+        int rename;
+        if (opts->zeroBss && shdrs[s].sh_offset + shdrs[s].sh_size <= img->size &&
+            is_all_zero(img->data + shdrs[s].sh_offset, (size_t)shdrs[s].sh_size))
+        {
+            // .bss 必须可写，全零节优先转为 NOBITS
+            rename = bss_section_name(name, sizeof(name), oldName);
+            shdrs[s].sh_type = 8;       // SHT_NOBITS
+            shdrs[s].sh_flags |= 1 | 2; // SHF_WRITE | SHF_ALLOC
+            printf("Converted zero-filled section '%s' of '%s' to NOBITS '%s' (%llu bytes)\n", oldName,
+                   file->filepath, rename ? name : oldName, (unsigned long long)shdrs[s].sh_size);
+        }
+        else if (opts->rewriteRodata)
+        {
+            rename = rodata_section_name(name, sizeof(name), oldName, FORMAT_ELF);
+            if (!(shdrs[s].sh_flags & 1) && !rename) // SHF_WRITE
+                continue;
+            shdrs[s].sh_flags = (shdrs[s].sh_flags & ~(uint64_t)1) | 2; // SHF_ALLOC
+            printf("Made section '%s' of '%s' read-only as '%s'\n", oldName, file->filepath, rename ? name : oldName);
+        }
+        else
+        {
+            continue;
+        }
+        if (rename)
+        {
+            int64_t offset = elf_add_name(&shstrtab, &strSize, &strCapacity, name);
+            ok = offset >= 0;
+            shdrs[s].sh_name = (uint32_t)offset;
+            renamed = 1;
+        }
+        (*changed)++;
+    }
+
+    if (ok && renamed)
+    {
+        int64_t offset = image_append(img, shstrtab, strSize, 1);
+        ok = offset >= 0;
+        shdrs[ehdr.e_shstrndx].sh_offset = (uint64_t)offset;
+        shdrs[ehdr.e_shstrndx].sh_size = strSize;
+    }
+    if (ok)
+        memcpy(img->data + ehdr.e_shoff, shdrs, ehdr.e_shnum * sizeof(Elf64_Shdr));
+    free(shstrtab);
+    free(shdrs);
+    return ok;
+}
+
+// 修改 COFF 节名：不超过 8 字节的直接存放，否则追加到字符串表；字符串表必须紧跟符号表，
+// 只有它位于文件末尾时才能原地扩展
+static int coff_rename_section(ObjImage *img, COFF_SECTION *sec, const char *name, size_t strOffset,
+                               uint32_t *strSize)
+{
+    size_t len = strlen(name);
+    memset(sec->Name, 0, 8);
+    if (len <= 8)
+    {
+        memcpy(sec->Name, name, len);
+        return 1;
+    }
+    if (strOffset + *strSize != img->size)
+        return 0;
+    char ref[9];
+    snprintf(ref, sizeof(ref), "/%u", *strSize);
+    if (image_append(img, name, len + 1, 1) < 0)
+        return 0;
+    memcpy(sec->Name, ref, strlen(ref));
+    *strSize += (uint32_t)(len + 1);
+    memcpy(img->data + strOffset, strSize, 4);
+    return 1;
+}
+
+// COFF：按选项修改资源所在节的节头（全零转为未初始化数据、IMAGE_SCN_ALIGN_* 位、IMAGE_SCN_MEM_WRITE）
+static int patch_coff_sections(ObjImage *img, const ObjectFile *file, const unsigned char *marked, const Options *opts,
+                               int *changed)
+{
+    COFF_HEADER hdr;
+    memcpy(&hdr, img->data, sizeof(hdr));
+    size_t sectionTable = sizeof(COFF_HEADER) + hdr.SizeOfOptionalHeader;
+    size_t strOffset = hdr.PointerToSymbolTable + (size_t)hdr.NumberOfSymbols * 18;
+    uint32_t strSize = 0;
+    if (sectionTable + (size_t)hdr.NumberOfSections * sizeof(COFF_SECTION) > img->size || strOffset + 4 > img->size)
+    {
+        fprintf(stderr, "Invalid section table in '%s'\n", file->filepath);
+        return 0;
+    }
+    memcpy(&strSize, img->data + strOffset, 4);
+
+    for (int s = 0; s < hdr.NumberOfSections && s < file->sectionCount; s++)
+    {
+        if (!marked[s])
+            continue;
+        COFF_SECTION sec;
+        memcpy(&sec, img->data + sectionTable + s * sizeof(COFF_SECTION), sizeof(sec));
+        const char *oldName = file->sections[s].name;
+        if (opts->realign && file->sections[s].align < opts->realign)
+        {
+            printf("Aligned section '%s' of '%s' to %u bytes (was %u)\n", oldName, file->filepath, opts->realign,
+                   file->sections[s].align);
+            sec.Characteristics = (sec.Characteristics & ~0x00F00000u) | coff_align_bits(opts->realign);
+            (*changed)++;
+        }
+
+        char name[600];
+        int rename = 0;
+        int modified = 0;
+        if ((opts->rewriteRodata || opts->zeroBss) && !file->sections[s].nobits && sec.NumberOfRelocations > 0)
+        {
+            fprintf(stderr, "Warning: section '%s' in '%s' has relocations, left unchanged\n", oldName,
+                    file->filepath);
+        }
+        else if (opts->zeroBss && !file->sections[s].nobits &&
+                 (size_t)sec.PointerToRawData + sec.SizeOfRawData <= img->size &&
+                 is_all_zero(img->data + sec.PointerToRawData, sec.SizeOfRawData))
+        {
+            // IMAGE_SCN_CNT_UNINITIALIZED_DATA | IMAGE_SCN_MEM_READ | IMAGE_SCN_MEM_WRITE，.bss 必须可写
+            rename = bss_section_name(name, sizeof(name), oldName);
+            sec.Characteristics = (sec.Characteristics & ~0x00000060u) | 0xC0000080u;
+            sec.PointerToRawData = 0;
+            printf("Converted zero-filled section '%s' of '%s' to uninitialized data '%s' (%u bytes)\n", oldName,
+                   file->filepath, rename ? name : oldName, sec.SizeOfRawData);
+            modified = 1;
+        }
+        else if (opts->rewriteRodata && !file->sections[s].nobits)
+        {
+            rename = rodata_section_name(name, sizeof(name), oldName, FORMAT_COFF);
+            if ((sec.Characteristics & 0x80000000u) || rename) // IMAGE_SCN_MEM_WRITE
+            {
+                sec.Characteristics = (sec.Characteristics & ~0x80000000u) | 0x40000000u; // IMAGE_SCN_MEM_READ
+                printf("Made section '%s' of '%s' read-only as '%s'\n", oldName, file->filepath,
+                       rename ? name : oldName);
+                modified = 1;
+            }
+        }
+        if (rename && !coff_rename_section(img, &sec, name, strOffset, &strSize))
+        {
+            fprintf(stderr, "Cannot extend string table of '%s' to rename '%s'\n", file->filepath, oldName);
+            return 0;
+        }
+        *changed += modified;
+        memcpy(img->data + sectionTable + s * sizeof(COFF_SECTION), &sec, sizeof(sec));
+    }
+    return 1;
+}
+
+// --short-names 的新符号前缀：有宏名时使用宏名（文件有多个资源时加序号），否则使用原前缀的 XXH64；
+// 两种名称都只取决于宏名或原符号名，重复构建时保持不变；新名称不比原名短时保留原名
+static void short_symbol_base(const ObjectFile *file, int index, const Options *opts, char *out, size_t outSize)
+{
+    const char *base = file->assets[index].base;
+    if (opts->shortNames == SHORT_NAMES_MACRO && file->macro && file->macro[0])
+    {
+        if (file->assetCount == 1)
+            snprintf(out, outSize, "_binary_%s", file->macro);
+        else
+            snprintf(out, outSize, "_binary_%s_%d", file->macro, index);
+    }
+    else
+    {
+        snprintf(out, outSize, "_binary_%016llx", (unsigned long long)xxh64(base, strlen(base), 0));
+    }
+    // 新名称不比原名短时保留原名，否则字符串表反而变大
+    if (strlen(out) >= strlen(base))
+        snprintf(out, outSize, "%s", base);
+}
+
+// 资源符号改名后的名称：name 为某个资源的 _start/_end/_size 符号且新前缀不同时写入 out，否则返回 0
+static int renamed_symbol(const ObjectFile *file, char *const *newBases, const char *name, char *out, size_t outSize)
+{
+    size_t suffixLen;
+    if (symbol_suffix(name, &suffixLen) == SUFFIX_NONE)
+        return 0;
+    size_t baseLen = strlen(name) - suffixLen;
+    for (int a = 0; a < file->assetCount; a++)
+    {
+        const char *base = file->assets[a].base;
+        if (strlen(base) == baseLen && strncmp(base, name, baseLen) == 0 && strcmp(newBases[a], base) != 0)
+        {
+            snprintf(out, outSize, "%s%s", newBases[a], name + baseLen);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 用新的字符串表替换旧表：不大于旧表时原地写入（旧表位于文件末尾时截断文件），否则只能在文件末尾扩展；
+// 返回新表在文件中的偏移，失败返回 -1
+static int64_t replace_string_table(ObjImage *img, size_t oldOffset, size_t oldSize, const char *table, size_t size)
+{
+    int atEnd = oldOffset + oldSize == img->size;
+    if (size <= oldSize)
+    {
+        memcpy(img->data + oldOffset, table, size);
+        memset(img->data + oldOffset + size, 0, oldSize - size);
+        if (atEnd)
+            img->size = oldOffset + size;
+        return (int64_t)oldOffset;
+    }
+    if (atEnd)
+    {
+        img->size = oldOffset;
+        return image_append(img, table, size, 1);
+    }
+    return image_append(img, table, size, 1);
+}
+
+// ELF：重建 .symtab 对应的字符串表，资源符号换成新名称（字符串表与节头字符串表共用时同时写入节名）
+static int rename_elf_symbols(ObjImage *img, const ObjectFile *file, char *const *newBases, int *renamed)
+{
+    Elf64_Ehdr ehdr;
+    memcpy(&ehdr, img->data, sizeof(ehdr));
+    Elf64_Shdr *shdrs = malloc(ehdr.e_shnum * sizeof(Elf64_Shdr));
+    if (!shdrs)
+    {
+        fprintf(stderr, "Memory allocation failed for section headers\n");
+        return 0;
+    }
+    memcpy(shdrs, img->data + ehdr.e_shoff, ehdr.e_shnum * sizeof(Elf64_Shdr));
+
+    int symIndex = -1;
+    for (int s = 0; s < ehdr.e_shnum && symIndex < 0; s++)
+        if (shdrs[s].sh_type == 2) // SHT_SYMTAB
+            symIndex = s;
+    if (symIndex < 0 || shdrs[symIndex].sh_link >= ehdr.e_shnum || shdrs[symIndex].sh_entsize != sizeof(Elf64_Sym) ||
+        shdrs[symIndex].sh_offset + shdrs[symIndex].sh_size > img->size)
+    {
+        fprintf(stderr, "Symbol table not found in '%s'\n", file->filepath);
+        free(shdrs);
+        return 0;
+    }
+    uint32_t strIndex = shdrs[symIndex].sh_link;
+    const char *oldTable = (const char *)img->data + shdrs[strIndex].sh_offset;
+    size_t oldSize = (size_t)shdrs[strIndex].sh_size;
+    size_t count = (size_t)(shdrs[symIndex].sh_size / sizeof(Elf64_Sym));
+    Elf64_Sym *syms = malloc(count ? count * sizeof(Elf64_Sym) : 1);
+    size_t size = 1;
+    size_t capacity = oldSize + 256;
+    char *table = malloc(capacity);
+    if (!syms || !table || shdrs[strIndex].sh_offset + oldSize > img->size)
+    {
+        fprintf(stderr, "Memory allocation failed for string table\n");
+        free(syms);
+        free(table);
+        free(shdrs);
+        return 0;
+    }
+    memcpy(syms, img->data + shdrs[symIndex].sh_offset, count * sizeof(Elf64_Sym));
+    table[0] = '\0';
+
+    int ok = 1;
+    int shared = strIndex == ehdr.e_shstrndx;
+    for (int s = 0; shared && s < ehdr.e_shnum && ok; s++)
+    {
+        int64_t offset = shdrs[s].sh_name < oldSize ? elf_add_name(&table, &size, &capacity, oldTable + shdrs[s].sh_name)
+                                                    : 0;
+        ok = offset >= 0;
+        shdrs[s].sh_name = (uint32_t)offset;
+    }
+    for (size_t i = 0; i < count && ok; i++)
+    {
+        if (syms[i].st_name == 0 || syms[i].st_name >= oldSize)
+            continue;
+        char name[600];
+        const char *oldName = oldTable + syms[i].st_name;
+        int changed = renamed_symbol(file, newBases, oldName, name, sizeof(name));
+        int64_t offset = elf_add_name(&table, &size, &capacity, changed ? name : oldName);
+        ok = offset >= 0;
+        syms[i].st_name = (uint32_t)offset;
+        *renamed += changed;
+    }
+
+    if (ok && *renamed > 0)
+    {
+        printf("Renamed %d symbol(s) of '%s', string table %zu -> %zu bytes\n", *renamed, file->filepath, oldSize,
+               size);
+        int64_t offset = replace_string_table(img, (size_t)shdrs[strIndex].sh_offset, oldSize, table, size);
+        ok = offset >= 0;
+        shdrs[strIndex].sh_offset = (uint64_t)offset;
+        shdrs[strIndex].sh_size = size;
+        if (ok)
+        {
+            memcpy(img->data + shdrs[symIndex].sh_offset, syms, count * sizeof(Elf64_Sym));
+            memcpy(img->data + ehdr.e_shoff, shdrs, ehdr.e_shnum * sizeof(Elf64_Shdr));
+        }
+    }
+    free(table);
+    free(syms);
+    free(shdrs);
+    return ok;
+}
+
+// 向 COFF 字符串表副本追加名称，返回名称的偏移，失败返回 0（偏移 0..3 是表大小，不会是合法偏移）
+static uint32_t coff_add_string(char **table, uint32_t *size, uint32_t *capacity, const char *name)
+{
+    size_t tableSize = *size;
+    size_t tableCapacity = *capacity;
+    int64_t offset = elf_add_name(table, &tableSize, &tableCapacity, name);
+    *size = (uint32_t)tableSize;
+    *capacity = (uint32_t)tableCapacity;
+    return offset < 0 ? 0 : (uint32_t)offset;
+}
+
+// COFF：重建字符串表，资源符号换成新名称；不超过 8 字节的名称直接存放在符号中，长节名重新指向新表
+static int rename_coff_symbols(ObjImage *img, const ObjectFile *file, char *const *newBases, int *renamed)
+{
+    COFF_HEADER hdr;
+    memcpy(&hdr, img->data, sizeof(hdr));
+    size_t sectionTable = sizeof(COFF_HEADER) + hdr.SizeOfOptionalHeader;
+    size_t strOffset = hdr.PointerToSymbolTable + (size_t)hdr.NumberOfSymbols * 18;
+    uint32_t oldSize = 0;
+    memcpy(&oldSize, img->data + strOffset, 4);
+    if (oldSize < 4 || strOffset + oldSize > img->size)
+    {
+        fprintf(stderr, "Invalid string table in '%s'\n", file->filepath);
+        return 0;
+    }
+    const char *oldTable = (const char *)img->data + strOffset;
+
+    uint32_t size = 4;
+    uint32_t capacity = oldSize + 256;
+    char *table = calloc(capacity, 1);
+    if (!table)
+    {
+        fprintf(stderr, "Memory allocation failed for string table\n");
+        return 0;
+    }
+
+    // 节头和符号记录先在副本中修改，新表写入成功后再写回
+    size_t headersSize = hdr.PointerToSymbolTable + (size_t)hdr.NumberOfSymbols * 18;
+    unsigned char *headers = malloc(headersSize);
+    if (!headers)
+    {
+        fprintf(stderr, "Memory allocation failed for symbol table\n");
+        free(table);
+        return 0;
+    }
+    memcpy(headers, img->data, headersSize);
+
+    int ok = 1;
+    for (int s = 0; s < hdr.NumberOfSections && ok; s++)
+    {
+        COFF_SECTION sec;
+        memcpy(&sec, headers + sectionTable + s * sizeof(COFF_SECTION), sizeof(sec));
+        if (sec.Name[0] != '/')
+            continue;
+        char ref[9];
+        memcpy(ref, sec.Name, 8);
+        ref[8] = '\0';
+        uint32_t old = (uint32_t)atoi(ref + 1);
+        uint32_t offset = old < oldSize ? coff_add_string(&table, &size, &capacity, oldTable + old) : 0;
+        ok = offset != 0;
+        snprintf(ref, sizeof(ref), "/%u", offset);
+        memset(sec.Name, 0, 8);
+        memcpy(sec.Name, ref, strlen(ref));
+        memcpy(headers + sectionTable + s * sizeof(COFF_SECTION), &sec, sizeof(sec));
+    }
+
+    for (uint32_t i = 0; i < hdr.NumberOfSymbols && ok; i++)
+    {
+        COFF_SYMBOL sym;
+        unsigned char *record = headers + hdr.PointerToSymbolTable + (size_t)i * 18;
+        memcpy(&sym, record, 18);
+        char oldName[600];
+        if (sym.Name.NameOffset.Zeroes == 0)
+        {
+            if (sym.Name.NameOffset.Offset >= oldSize)
+            {
+                ok = 0;
+                break;
+            }
+            snprintf(oldName, sizeof(oldName), "%s", oldTable + sym.Name.NameOffset.Offset);
+        }
+        else
+        {
+            memcpy(oldName, sym.Name.Name, 8);
+            oldName[8] = '\0';
+        }
+
+        char name[600];
+        int changed = renamed_symbol(file, newBases, oldName, name, sizeof(name));
+        const char *newName = changed ? name : oldName;
+        if (changed || sym.Name.NameOffset.Zeroes == 0)
+        {
+            memset(sym.Name.Name, 0, 8);
+            if (strlen(newName) <= 8)
+            {
+                memcpy(sym.Name.Name, newName, strlen(newName));
+            }
+            else
+            {
+                sym.Name.NameOffset.Offset = coff_add_string(&table, &size, &capacity, newName);
+                ok = sym.Name.NameOffset.Offset != 0;
+            }
+            memcpy(record, &sym, 18);
+        }
+        *renamed += changed;
+        i += sym.NumberOfAuxSymbols;
+    }
+
+    if (!ok)
+        fprintf(stderr, "Cannot rebuild string table of '%s'\n", file->filepath);
+    if (ok && *renamed > 0)
+    {
+        printf("Renamed %d symbol(s) of '%s', string table %u -> %u bytes\n", *renamed, file->filepath, oldSize,
+               size);
+        memcpy(table, &size, 4);
+        // 字符串表必须紧跟符号表，不能移动
+        if (size > oldSize && strOffset + oldSize != img->size)
+        {
+            fprintf(stderr, "Cannot extend string table of '%s'\n", file->filepath);
+            ok = 0;
+        }
+        else
+        {
+            memcpy(img->data, headers, headersSize);
+            ok = replace_string_table(img, strOffset, oldSize, table, size) >= 0;
+        }
+    }
+    free(headers);
+    free(table);
+    return ok;
+}
+
+// 原地修改输入对象中资源所在节的节头和资源符号名，写出 <outDir>/<name>.patched.o（工具自己生成的对象直接更新），
+// 对象中的其它内容和偏移保持不变：
+// --rewrite-rodata 把 ld -r -b binary / objcopy 放在可写 .data 节中的数据改为只读，只读页可以在多个进程之间共享；
+// --realign 提高节的对齐（objcopy 生成的节只按 1 字节对齐），SIMD 和 SPIR-V 代码可以直接对齐访问；
+// --zero-bss 把全零的节转为未初始化数据，最终文件中不再占用空间；
+// --short-names 把由构建路径得到的长符号名改为短名称，缩小字符串表并加快链接时的符号解析
+static int patch_object(const char *outDir, ObjectFile *file, const Options *opts)
+{
+    unsigned char *marked = malloc(file->sectionCount ? file->sectionCount : 1);
+    if (!marked)
+    {
+        fprintf(stderr, "Memory allocation failed for section marks\n");
+        return 0;
+    }
+    if (mark_asset_sections(file, marked) == 0 && !opts->shortNames)
+    {
+        free(marked);
+        return 1;
+    }
+
+    ObjImage img;
+    if (!load_image(&img, file->filepath))
+    {
+        free(marked);
+        return 0;
+    }
+
+    int changed = 0;
+    int ok = file->format == FORMAT_COFF ? patch_coff_sections(&img, file, marked, opts, &changed)
+                                         : patch_elf_sections(&img, file, marked, opts, &changed);
+    free(marked);
+
+    // 改名后重新解析时资源顺序不变，按下标恢复改名前的前缀
+    int count = file->assetCount;
+    char **newBases = calloc(count ? count : 1, sizeof(char *));
+    char **oldBases = calloc(count ? count : 1, sizeof(char *));
+    if (!newBases || !oldBases)
+    {
+        fprintf(stderr, "Memory allocation failed for symbol names\n");
+        ok = 0;
+    }
+    for (int a = 0; ok && opts->shortNames && a < count; a++)
+    {
+        char name[600];
+        short_symbol_base(file, a, opts, name, sizeof(name));
+        newBases[a] = my_strdup(name);
+        oldBases[a] = my_strdup(file->assets[a].origBase ? file->assets[a].origBase : file->assets[a].base);
+        ok = newBases[a] && oldBases[a];
+    }
+    if (ok && opts->shortNames)
+    {
+        ok = file->format == FORMAT_COFF ? rename_coff_symbols(&img, file, newBases, &changed)
+                                         : rename_elf_symbols(&img, file, newBases, &changed);
+    }
+
+    // 节内不在对齐位置开始的资源不会因为提高节对齐而对齐
+    for (int a = 0; ok && opts->realign && a < file->assetCount; a++)
+    {
+        const Asset *asset = &file->assets[a];
+        if (asset->start >= 0 && symbol_section(file, &file->symbols[asset->start]) &&
+            file->symbols[asset->start].value % opts->realign != 0)
+        {
+            fprintf(stderr, "Warning: '%s' starts at offset %u of its section in '%s', not a multiple of %u\n",
+                    asset->base, file->symbols[asset->start].value, file->filepath, opts->realign);
+        }
+    }
+
+    if (ok && changed > 0)
+    {
+        char path[1400];
+        if (strcmp(file->filepath, file->inputPath) != 0)
+            snprintf(path, sizeof(path), "%s", file->filepath);
+        else
+            rewritten_object_path(path, sizeof(path), outDir, file, "patched");
+        ok = save_image(&img, path) && reload_object(file, path, opts);
+    }
+    for (int a = 0; ok && opts->shortNames && a < file->assetCount; a++)
+    {
+        for (int b = 0; b < count; b++)
+        {
+            if (newBases[b] && strcmp(file->assets[a].base, newBases[b]) == 0 &&
+                strcmp(newBases[b], oldBases[b]) != 0)
+            {
+                file->assets[a].origBase = my_strdup(oldBases[b]);
+                break;
+            }
+        }
+    }
+    for (int a = 0; a < count; a++)
+    {
+        if (newBases)
+            free(newBases[a]);
+        if (oldBases)
+            free(oldBases[a]);
+    }
+    free(newBases);
+    free(oldBases);
+    free_image(&img);
+    return ok;
+}
+
+// LZ4 块格式压缩：哈希链贪心匹配，比参考实现的快速模式压缩率更高，解码格式完全兼容
+#define LZ4_HASH_BITS 16
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_CHAIN_DEPTH 64
+#define LZ4_LAST_LITERALS 5 // 块末尾至少 5 字节为字面量
+#define LZ4_MF_LIMIT 12     // 最后一个匹配必须在块末尾 12 字节之前开始
+
+static size_t lz4_bound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+static uint32_t lz4_hash(const unsigned char *p)
+{
+    return (read_le32(p) * 2654435761u) >> (32 - LZ4_HASH_BITS);
+}
+
+static unsigned char *lz4_write_length(unsigned char *op, size_t len)
+{
+    while (len >= 255)
+    {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (unsigned char)len;
+    return op;
+}
+
+// 压缩 src 到 dst（容量至少为 lz4_bound(srcSize)），dict 视为已解码的历史数据，匹配可以引用其末尾 64 KiB；
+// 返回压缩后的大小，内存不足时返回 0
+static size_t lz4_compress(const unsigned char *dict, size_t dictSize, const unsigned char *src, size_t srcSize,
+                           unsigned char *dst)
+{
+    if (dictSize > LZ4_MAX_OFFSET)
+    {
+        dict += dictSize - LZ4_MAX_OFFSET;
+        dictSize = LZ4_MAX_OFFSET;
+    }
+    size_t total = dictSize + srcSize;
+    unsigned char *buf = malloc(total ? total : 1);
+    int32_t *head = malloc(((size_t)1 << LZ4_HASH_BITS) * sizeof(int32_t));
+    int32_t *prev = malloc((total ? total : 1) * sizeof(int32_t));
+    if (!buf || !head || !prev)
+    {
+        fprintf(stderr, "Memory allocation failed for compression\n");
+        free(buf);
+        free(head);
+        free(prev);
+        return 0;
+    }
+    if (dictSize > 0)
+        memcpy(buf, dict, dictSize);
+    if (srcSize > 0)
+        memcpy(buf + dictSize, src, srcSize);
+    for (size_t i = 0; i < ((size_t)1 << LZ4_HASH_BITS); i++)
+        head[i] = -1;
+
+    for (size_t i = 0; i + 4 <= dictSize; i++)
+    {
+        uint32_t hv = lz4_hash(buf + i);
+        prev[i] = head[hv];
+        head[hv] = (int32_t)i;
+    }
+
+    unsigned char *op = dst;
+    size_t anchor = dictSize;
+    size_t pos = dictSize;
+    size_t matchLimit = total >= LZ4_LAST_LITERALS ? total - LZ4_LAST_LITERALS : 0;
+    while (srcSize >= LZ4_MF_LIMIT + 1 && pos + LZ4_MF_LIMIT <= total)
+    {
+        uint32_t hv = lz4_hash(buf + pos);
+        size_t bestLen = 0;
+        size_t bestPos = 0;
+        int depth = LZ4_CHAIN_DEPTH;
+        for (int32_t c = head[hv]; c >= 0 && depth-- > 0 && pos - (size_t)c <= LZ4_MAX_OFFSET; c = prev[c])
+        {
+            size_t len = 0;
+            while (pos + len < matchLimit && buf[c + len] == buf[pos + len])
+                len++;
+            if (len > bestLen)
+            {
+                bestLen = len;
+                bestPos = (size_t)c;
+            }
+        }
+        prev[pos] = head[hv];
+        head[hv] = (int32_t)pos;
+
+        if (bestLen < 4)
+        {
+            pos++;
+            continue;
+        }
+
+        size_t litLen = pos - anchor;
+        size_t matchLen = bestLen - 4;
+        unsigned char *token = op++;
+        *token = (unsigned char)(((litLen < 15 ? litLen : 15) << 4) | (matchLen < 15 ? matchLen : 15));
+        if (litLen >= 15)
+            op = lz4_write_length(op, litLen - 15);
+        memcpy(op, buf + anchor, litLen);
+        op += litLen;
+        size_t offset = pos - bestPos;
+        *op++ = (unsigned char)(offset & 0xFF);
+        *op++ = (unsigned char)(offset >> 8);
+        if (matchLen >= 15)
+            op = lz4_write_length(op, matchLen - 15);
+
+        // 匹配覆盖的位置也加入哈希链
+        for (size_t i = pos + 1; i < pos + bestLen && i + 4 <= total; i++)
+        {
+            uint32_t hi = lz4_hash(buf + i);
+            prev[i] = head[hi];
+            head[hi] = (int32_t)i;
+        }
+        pos += bestLen;
+        anchor = pos;
+    }
+
+    // 最后一个序列只有字面量
+    size_t litLen = total - anchor;
+    *op++ = (unsigned char)((litLen < 15 ? litLen : 15) << 4);
+    if (litLen >= 15)
+        op = lz4_write_length(op, litLen - 15);
+    memcpy(op, buf + anchor, litLen);
+    op += litLen;
+
+    free(buf);
+    free(head);
+    free(prev);
+    return (size_t)(op - dst);
+}
+
+// 字典训练的取样块
+#define DICT_BLOCK 32
+
+typedef struct
+{
+    uint64_t hash;
+    int used;
+    int lastAsset; // 最近一次计数的资源，避免同一资源重复计数
+    int assets;    // 出现在多少个不同资源中
+    int srcAsset;  // 首次出现的位置
+    uint32_t srcOffset;
+} DictEntry;
+
+typedef struct
+{
+    int asset;
+    uint32_t start;
+    uint32_t end;
+} DictRange;
+
+static int compare_dict_entries(const void *a, const void *b)
+{
+    const DictEntry *x = a;
+    const DictEntry *y = b;
+    if (x->assets != y->assets)
+        return y->assets - x->assets;
+    if (x->srcAsset != y->srcAsset)
+        return x->srcAsset - y->srcAsset;
+    return x->srcOffset < y->srcOffset ? -1 : x->srcOffset > y->srcOffset;
+}
+
+// 训练共享字典：按 4 字节步长取样 32 字节块，统计每个块出现在多少个不同资源中，
+// 选取至少出现在两个资源中的块，相邻或重叠的块合并为连续片段；出现次数最多的片段放在字典末尾，
+// 使其偏移最小。返回字典大小
+static size_t train_dictionary(unsigned char *const *payloads, const size_t *sizes, int count, unsigned char *dict,
+                               size_t dictCap)
+{
+    // 输入很大时加大步长，取样数控制在约一百万
+    uint64_t totalBytes = 0;
+    for (int i = 0; i < count; i++)
+        totalBytes += sizes[i];
+    uint64_t stride = 4;
+    while (totalBytes / stride > ((uint64_t)1 << 20))
+        stride *= 2;
+
+    size_t samples = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (sizes[i] >= DICT_BLOCK)
+            samples += (sizes[i] - DICT_BLOCK) / stride + 1;
+    }
+    if (samples == 0)
+        return 0;
+
+    size_t capacity = 1;
+    while (capacity < samples * 2)
+        capacity *= 2;
+    DictEntry *table = calloc(capacity, sizeof(DictEntry));
+    if (!table)
+    {
+        fprintf(stderr, "Memory allocation failed for dictionary training\n");
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        for (uint64_t off = 0; sizes[i] >= DICT_BLOCK && off + DICT_BLOCK <= sizes[i]; off += stride)
+        {
+            uint64_t hv = xxh64(payloads[i] + off, DICT_BLOCK, 0);
+            size_t slot = (size_t)hv & (capacity - 1);
+            while (table[slot].used && table[slot].hash != hv)
+                slot = (slot + 1) & (capacity - 1);
+            DictEntry *e = &table[slot];
+            if (!e->used)
+            {
+                e->used = 1;
+                e->hash = hv;
+                e->lastAsset = -1;
+                e->srcAsset = i;
+                e->srcOffset = (uint32_t)off;
+            }
+            if (e->lastAsset != i)
+            {
+                e->lastAsset = i;
+                e->assets++;
+            }
+        }
+    }
+
+    // 只保留跨资源共享的块，按出现次数排序
+    size_t candidates = 0;
+    for (size_t s = 0; s < capacity; s++)
+    {
+        if (table[s].used && table[s].assets >= 2)
+            table[candidates++] = table[s];
+    }
+    qsort(table, candidates, sizeof(DictEntry), compare_dict_entries);
+
+    DictRange *ranges = malloc((candidates ? candidates : 1) * sizeof(DictRange));
+    if (!ranges)
+    {
+        fprintf(stderr, "Memory allocation failed for dictionary training\n");
+        free(table);
+        return 0;
+    }
+    int rangeCount = 0;
+    size_t used = 0;
+    for (size_t c = 0; c < candidates && used < dictCap; c++)
+    {
+        uint32_t start = table[c].srcOffset;
+        uint32_t end = start + DICT_BLOCK;
+        int merged = 0;
+        for (int r = 0; r < rangeCount && !merged; r++)
+        {
+            DictRange *range = &ranges[r];
+            if (range->asset != table[c].srcAsset || start > range->end || end < range->start)
+                continue;
+            uint32_t newStart = start < range->start ? start : range->start;
+            uint32_t newEnd = end > range->end ? end : range->end;
+            size_t grow = (newEnd - newStart) - (range->end - range->start);
+            if (used + grow <= dictCap)
+            {
+                used += grow;
+                range->start = newStart;
+                range->end = newEnd;
+            }
+            merged = 1;
+        }
+        if (!merged && used + DICT_BLOCK <= dictCap)
+        {
+            ranges[rangeCount].asset = table[c].srcAsset;
+            ranges[rangeCount].start = start;
+            ranges[rangeCount].end = end;
+            rangeCount++;
+            used += DICT_BLOCK;
+        }
+        if (!merged && used + DICT_BLOCK > dictCap)
+            break;
+    }
+
+    size_t size = 0;
+    for (int r = rangeCount - 1; r >= 0; r--)
+    {
+        memcpy(dict + size, payloads[ranges[r].asset] + ranges[r].start, ranges[r].end - ranges[r].start);
+        size += ranges[r].end - ranges[r].start;
+    }
+
+    free(ranges);
+    free(table);
+    return size;
+}
+
+// 压缩模式：每个输入对象的资源压缩后写入 <outDir>/<name>.lz4.o，符号为 <原前缀>_lz4_start/_end/_size；
+// 指定共享字典时先用全部资源训练字典，写入 <outDir>/<headerStem>.dict.lz4.o
+static int compress_assets(const char *outDir, const char *headerName, ObjectFile *files, int fileCount, Options *opts)
+{
+    char normalizedDir[1024];
+    normalize_path(normalizedDir, sizeof(normalizedDir), outDir);
+
+    // 读取全部规范资源（重复资源复用规范资源的压缩数据）
+    int total = 0;
+    for (int f = 0; f < fileCount; f++)
+        total += files[f].assetCount;
+    unsigned char **payloads = calloc(total ? total : 1, sizeof(unsigned char *));
+    size_t *sizes = calloc(total ? total : 1, sizeof(size_t));
+    int *owners = calloc(total ? total : 1, sizeof(int));
+    if (!payloads || !sizes || !owners)
+    {
+        fprintf(stderr, "Memory allocation failed for compression\n");
+        free(payloads);
+        free(sizes);
+        free(owners);
+        return 0;
+    }
+    int loaded = 0;
+    int n = 0;
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++, n++)
+        {
+            if (files[f].assets[a].aliasFile)
+                continue;
+            if (read_asset_payload(&files[f], &files[f].assets[a], &payloads[n], &sizes[n]))
+                owners[loaded++] = n;
+        }
+    }
+
+    int ok = 1;
+    unsigned char *dict = NULL;
+    size_t dictSize = 0;
+    if (opts->compressDict > 0 && loaded > 0)
+    {
+        unsigned char **samples = malloc(loaded * sizeof(unsigned char *));
+        size_t *sampleSizes = malloc(loaded * sizeof(size_t));
+        dict = malloc(opts->compressDict);
+        if (!samples || !sampleSizes || !dict)
+        {
+            fprintf(stderr, "Memory allocation failed for dictionary training\n");
+            free(samples);
+            free(sampleSizes);
+            free(dict);
+            dict = NULL;
+            ok = 0;
+        }
+        else
+        {
+            for (int i = 0; i < loaded; i++)
+            {
+                samples[i] = payloads[owners[i]];
+                sampleSizes[i] = sizes[owners[i]];
+            }
+            dictSize = train_dictionary(samples, sampleSizes, loaded, dict, opts->compressDict);
+            free(samples);
+            free(sampleSizes);
+        }
+
+        if (ok && dictSize == 0)
+        {
+            printf("Dictionary: no blocks shared between assets, compressing without a dictionary\n");
+        }
+        else if (ok)
+        {
+            char stem[256];
+            char ident[256];
+            header_stem(stem, sizeof(stem), headerName);
+            dir_to_ident(ident, sizeof(ident), stem);
+            snprintf(opts->dictBase, sizeof(opts->dictBase), "_binary_%s_lz4_dict", ident);
+
+            char name[700];
+            char path[1400];
+            printf("Dictionary: %zu bytes trained from %d assets\n", dictSize, loaded);
+            ObjWriter w;
+            writer_init(&w, files[0].format, files[0].machine);
+            int sec = writer_add_section(&w, files[0].format == FORMAT_COFF ? ".rdata" : ".rodata", 16);
+            snprintf(name, sizeof(name), "%s_start", opts->dictBase);
+            ok = sec >= 0 && writer_append(&w, sec, dict, dictSize, 1) >= 0 && writer_add_symbol(&w, name, sec, 0);
+            snprintf(name, sizeof(name), "%s_end", opts->dictBase);
+            ok = ok && writer_add_symbol(&w, name, sec, (uint32_t)dictSize);
+            snprintf(name, sizeof(name), "%s_size", opts->dictBase);
+            ok = ok && writer_add_symbol(&w, name, -1, (uint32_t)dictSize);
+            snprintf(path, sizeof(path), "%s/%s.dict.lz4.o", normalizedDir, stem);
+            ok = ok && save_object(&w, path);
+            free_writer(&w);
+
+            opts->dictSize = (uint32_t)dictSize;
+        }
+    }
+
+    // 逐个对象压缩并写出
+    uint64_t rawTotal = 0;
+    uint64_t packedTotal = 0;
+    int packedCount = 0;
+    int rawStored = 0;
+    n = 0;
+    for (int f = 0; f < fileCount && ok; f++)
+    {
+        ObjWriter w;
+        writer_init(&w, files[f].format, files[f].machine);
+        int shared = -1;
+        for (int a = 0; a < files[f].assetCount && ok; a++, n++)
+        {
+            Asset *asset = &files[f].assets[a];
+            if (asset->aliasFile || !payloads[n])
+                continue;
+
+            unsigned char *packed = malloc(lz4_bound(sizes[n]));
+            size_t packedSize = packed ? lz4_compress(dict, dictSize, payloads[n], sizes[n], packed) : 0;
+            if (packedSize == 0)
+            {
+                fprintf(stderr, "Failed to compress '%s'\n", asset->base);
+                free(packed);
+                ok = 0;
+                break;
+            }
+
+            // 压缩后不比原始数据小（已压缩或随机数据）时原样存放，与 --delta 的 DELTA_RAW 相同
+            const unsigned char *stored = packed;
+            asset->packedRaw = packedSize >= sizes[n];
+            if (asset->packedRaw)
+            {
+                stored = payloads[n];
+                packedSize = sizes[n];
+                rawStored++;
+            }
+
+            char name[600];
+            int sec = writer_asset_section(&w, &shared, files[f].format == FORMAT_COFF ? ".rdata" : ".rodata",
+                                           asset->base, 16, opts);
+            int64_t offset = sec >= 0 ? writer_append(&w, sec, stored, packedSize, 1) : -1;
+            snprintf(name, sizeof(name), "%s_lz4_start", asset->base);
+            ok = offset >= 0 && writer_add_symbol(&w, name, sec, (uint32_t)offset);
+            snprintf(name, sizeof(name), "%s_lz4_end", asset->base);
+            ok = ok && writer_add_symbol(&w, name, sec, (uint32_t)(offset + packedSize));
+            snprintf(name, sizeof(name), "%s_lz4_size", asset->base);
+            ok = ok && writer_add_symbol(&w, name, -1, (uint32_t)packedSize);
+            free(packed);
+
+            asset->packedSize = packedSize;
+            rawTotal += sizes[n];
+            packedTotal += packedSize;
+            packedCount++;
+        }
+
+        if (ok && w.symbolCount > 0)
+        {
+            char *base = basename(files[f].inputPath);
+            char path[1100];
+            snprintf(path, sizeof(path), "%s/%s.lz4.o", normalizedDir, base);
+            ok = save_object(&w, path);
+            free(base);
+        }
+        free_writer(&w);
+    }
+
+    if (ok && packedCount > 0)
+    {
+        printf("Compressed %d assets: %llu -> %llu bytes (%.1f%%)\n", packedCount, (unsigned long long)rawTotal,
+               (unsigned long long)packedTotal, rawTotal ? 100.0 * packedTotal / rawTotal : 0.0);
+        if (rawStored > 0)
+            printf("Stored %d incompressible assets uncompressed\n", rawStored);
+    }
+
+    for (int i = 0; i < total; i++)
+        free(payloads[i]);
+    free(payloads);
+    free(sizes);
+    free(owners);
+    free(dict);
+    return ok;
+}
+
+// 差分编码：同组资源中选出基准资源原样存放，其余资源编码为相对基准的复制/插入序列（只记录与基准的差异），
+// 全部写入 <outDir>/<headerStem>.delta.o；默认所有输入为一组，也可以按目录分组
+#define DELTA_CANDIDATES 16
+#define DELTA_HASH_BITS 16
+#define DELTA_MIN_MATCH 8 // 一次复制至少 8 字节，编码（长度 + 32 位偏移）才比直接存放短
+#define DELTA_CHAIN_DEPTH 32
+
+// 差分格式：重复 [字面量长度 varint][字面量][复制长度 varint][基准中的偏移，32 位小端]，以字面量结尾。
+// 偏移是基准资源内的绝对位置，不受 LZ4 64 KiB 窗口的限制，任意大小的资源都可以从基准复制
+typedef struct
+{
+    const unsigned char *base;
+    size_t size;
+    int32_t *head;
+    int32_t *prev;
+} DeltaIndex;
+
+static uint32_t delta_hash(const unsigned char *p)
+{
+    return (uint32_t)((read_le64(p) * XXH_PRIME64_1) >> (64 - DELTA_HASH_BITS));
+}
+
+// 为基准资源的每个位置建立 8 字节哈希链
+static int delta_index_init(DeltaIndex *idx, const unsigned char *base, size_t size)
+{
+    idx->base = base;
+    idx->size = size;
+    idx->head = malloc(((size_t)1 << DELTA_HASH_BITS) * sizeof(int32_t));
+    idx->prev = malloc((size ? size : 1) * sizeof(int32_t));
+    if (!idx->head || !idx->prev || size > 0x7FFFFFFF)
+    {
+        free(idx->head);
+        free(idx->prev);
+        idx->head = idx->prev = NULL;
+        return 0;
+    }
+    for (size_t i = 0; i < ((size_t)1 << DELTA_HASH_BITS); i++)
+        idx->head[i] = -1;
+    for (size_t i = 0; i + DELTA_MIN_MATCH <= size; i++)
+    {
+        uint32_t hv = delta_hash(base + i);
+        idx->prev[i] = idx->head[hv];
+        idx->head[hv] = (int32_t)i;
+    }
+    return 1;
+}
+
+static void delta_index_free(DeltaIndex *idx)
+{
+    free(idx->head);
+    free(idx->prev);
+}
+
+// 差分输出的最大长度：每次复制至少覆盖 8 字节而编码不超过 6 字节加上字面量长度的 varint
+static size_t delta_bound(size_t size)
+{
+    return size + size / 64 + 16;
+}
+
+static unsigned char *delta_write_varint(unsigned char *op, size_t v)
+{
+    while (v >= 0x80)
+    {
+        *op++ = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    *op++ = (unsigned char)v;
+    return op;
+}
+
+// 把 src 编码为相对基准的复制/插入序列，返回编码后的字节数；dst 至少需要 delta_bound(srcSize) 字节
+static size_t delta_encode(const DeltaIndex *idx, const unsigned char *src, size_t srcSize, unsigned char *dst)
+{
+    const unsigned char *base = idx->base;
+    unsigned char *op = dst;
+    size_t anchor = 0;
+    size_t pos = 0;
+    while (pos + DELTA_MIN_MATCH <= srcSize)
+    {
+        size_t bestLen = 0;
+        size_t bestPos = 0;
+        int depth = DELTA_CHAIN_DEPTH;
+        for (int32_t c = idx->head[delta_hash(src + pos)]; c >= 0 && depth-- > 0; c = idx->prev[c])
+        {
+            size_t len = 0;
+            while ((size_t)c + len < idx->size && pos + len < srcSize && base[c + len] == src[pos + len])
+                len++;
+            if (len > bestLen)
+            {
+                bestLen = len;
+                bestPos = (size_t)c;
+            }
+        }
+        if (bestLen < DELTA_MIN_MATCH)
+        {
+            pos++;
+            continue;
+        }
+
+        // 向前扩展匹配，吸收尚未输出的字面量
+        while (pos > anchor && bestPos > 0 && base[bestPos - 1] == src[pos - 1])
+        {
+            pos--;
+            bestPos--;
+            bestLen++;
+        }
+        op = delta_write_varint(op, pos - anchor);
+        memcpy(op, src + anchor, pos - anchor);
+        op += pos - anchor;
+        op = delta_write_varint(op, bestLen);
+        for (int b = 0; b < 4; b++)
+            *op++ = (unsigned char)(bestPos >> (8 * b));
+        pos += bestLen;
+        anchor = pos;
+    }
+    op = delta_write_varint(op, srcSize - anchor);
+    memcpy(op, src + anchor, srcSize - anchor);
+    op += srcSize - anchor;
+    return (size_t)(op - dst);
+}
+
+// 相对基准编码后的大小，失败返回 0
+static size_t delta_encoded_size(const DeltaIndex *idx, const unsigned char *src, size_t srcSize)
+{
+    unsigned char *packed = malloc(delta_bound(srcSize));
+    if (!packed)
+        return 0;
+    size_t size = delta_encode(idx, src, srcSize, packed);
+    free(packed);
+    return size;
+}
+
+static int delta_encode_assets(const char *outDir, const char *headerName, ObjectFile *files, int fileCount,
+                               const Options *opts)
+{
+    int total = 0;
+    for (int f = 0; f < fileCount; f++)
+        total += files[f].assetCount;
+
+    // 展开为资源列表，记录每个资源所属的组
+    unsigned char **payloads = calloc(total ? total : 1, sizeof(unsigned char *));
+    size_t *sizes = calloc(total ? total : 1, sizeof(size_t));
+    int *fileOf = calloc(total ? total : 1, sizeof(int));
+    int *assetOf = calloc(total ? total : 1, sizeof(int));
+    int *groupOf = calloc(total ? total : 1, sizeof(int));
+    char (*keys)[1024] = malloc((fileCount ? fileCount : 1) * sizeof(*keys));
+    if (!payloads || !sizes || !fileOf || !assetOf || !groupOf || !keys)
+    {
+        fprintf(stderr, "Memory allocation failed for delta encoding\n");
+        free(payloads);
+        free(sizes);
+        free(fileOf);
+        free(assetOf);
+        free(groupOf);
+        free(keys);
+        return 0;
+    }
+
+    int groupCount = 0;
+    int n = 0;
+    for (int f = 0; f < fileCount; f++)
+    {
+        char key[1024] = ".";
+        if (opts->deltaByDir)
+        {
+            char shown[1024];
+            display_path(shown, sizeof(shown), files[f].filepath, opts);
+            file_dir_key(key, sizeof(key), shown);
+        }
+        int g = 0;
+        while (g < groupCount && strcmp(keys[g], key) != 0)
+            g++;
+        if (g == groupCount)
+        {
+            snprintf(keys[g], sizeof(keys[g]), "%s", key);
+            groupCount++;
+        }
+
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            fileOf[n] = f;
+            assetOf[n] = a;
+            groupOf[n] = g;
+            // 重复资源复用规范资源的存储
+            if (!files[f].assets[a].aliasFile && !read_asset_payload(&files[f], &files[f].assets[a], &payloads[n], &sizes[n]))
+                payloads[n] = NULL;
+            n++;
+        }
+    }
+
+    ObjWriter w;
+    writer_init(&w, files[0].format, files[0].machine);
+    int shared = -1;
+    int ok = 1;
+    uint64_t rawTotal = 0;
+    uint64_t storedTotal = 0;
+    int deltaCount = 0;
+
+    for (int g = 0; g < groupCount && ok; g++)
+    {
+        // 选基准：在前 DELTA_CANDIDATES 个资源中，选基准本身加上同组其他资源（取样）差分后总大小最小的一个
+        int members = 0;
+        for (int i = 0; i < total; i++)
+        {
+            if (groupOf[i] == g && payloads[i])
+                members++;
+        }
+        if (members == 0)
+            continue;
+
+        int base = -1;
+        uint64_t bestCost = UINT64_MAX;
+        DeltaIndex baseIndex;
+        int tried = 0;
+        for (int c = 0; c < total && tried < DELTA_CANDIDATES; c++)
+        {
+            if (groupOf[c] != g || !payloads[c])
+                continue;
+            DeltaIndex idx;
+            if (!delta_index_init(&idx, payloads[c], sizes[c]))
+                continue;
+            tried++;
+            uint64_t cost = sizes[c];
+            int sampled = 0;
+            for (int i = 0; i < total && sampled < DELTA_CANDIDATES; i++)
+            {
+                if (i == c || groupOf[i] != g || !payloads[i])
+                    continue;
+                size_t deltaSize = delta_encoded_size(&idx, payloads[i], sizes[i]);
+                cost += deltaSize > 0 && deltaSize < sizes[i] ? deltaSize : sizes[i];
+                sampled++;
+            }
+            delta_index_free(&idx);
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                base = c;
+            }
+        }
+
+        if (base < 0 || !delta_index_init(&baseIndex, payloads[base], sizes[base]))
+        {
+            fprintf(stderr, "Memory allocation failed for delta encoding\n");
+            ok = 0;
+            break;
+        }
+
+        // 基准放在组内最前面，原样存放
+        for (int pass = 0; pass < 2 && ok; pass++)
+        {
+            for (int i = 0; i < total && ok; i++)
+            {
+                if (groupOf[i] != g || !payloads[i] || (pass == 0) != (i == base))
+                    continue;
+
+                Asset *asset = &files[fileOf[i]].assets[assetOf[i]];
+                const unsigned char *stored = payloads[i];
+                size_t storedSize = sizes[i];
+                unsigned char *packed = NULL;
+                asset->deltaKind = DELTA_RAW;
+                asset->deltaBaseFile = NULL;
+                asset->deltaBaseAsset = -1;
+                if (i != base)
+                {
+                    // 差分与独立压缩取较小者，都不比原始数据小时原样存放
+                    packed = malloc(delta_bound(sizes[i]) + lz4_bound(sizes[i]));
+                    if (!packed)
+                    {
+                        fprintf(stderr, "Memory allocation failed for delta encoding\n");
+                        ok = 0;
+                        break;
+                    }
+                    unsigned char *solo = packed + delta_bound(sizes[i]);
+                    size_t deltaSize = delta_encode(&baseIndex, payloads[i], sizes[i], packed);
+                    size_t soloSize = lz4_compress(NULL, 0, payloads[i], sizes[i], solo);
+                    if (deltaSize > 0 && (soloSize == 0 || deltaSize <= soloSize) && deltaSize < sizes[i])
+                    {
+                        stored = packed;
+                        storedSize = deltaSize;
+                        asset->deltaKind = DELTA_COPY;
+                        asset->deltaBaseFile = &files[fileOf[base]];
+                        asset->deltaBaseAsset = assetOf[base];
+                        deltaCount++;
+                    }
+                    else if (soloSize > 0 && soloSize < sizes[i])
+                    {
+                        stored = solo;
+                        storedSize = soloSize;
+                        asset->deltaKind = DELTA_LZ4;
+                    }
+                }
+
+                char name[600];
+                int sec = writer_asset_section(&w, &shared, files[0].format == FORMAT_COFF ? ".rdata" : ".rodata",
+                                               asset->base, 16, opts);
+                int64_t offset = sec >= 0 ? writer_append(&w, sec, stored, storedSize, 16) : -1;
+                snprintf(name, sizeof(name), "%s_delta_start", asset->base);
+                ok = offset >= 0 && writer_add_symbol(&w, name, sec, (uint32_t)offset);
+                snprintf(name, sizeof(name), "%s_delta_end", asset->base);
+                ok = ok && writer_add_symbol(&w, name, sec, (uint32_t)(offset + storedSize));
+                snprintf(name, sizeof(name), "%s_delta_size", asset->base);
+                ok = ok && writer_add_symbol(&w, name, -1, (uint32_t)storedSize);
+                free(packed);
+
+                asset->deltaSize = storedSize;
+                rawTotal += sizes[i];
+                storedTotal += storedSize;
+            }
+        }
+
+        delta_index_free(&baseIndex);
+        const ObjectFile *baseFile = &files[fileOf[base]];
+        printf("Delta group '%s': %d assets, base %s\n", keys[g], members, baseFile->assets[assetOf[base]].base);
+    }
+
+    if (ok)
+    {
+        char normalizedDir[1024];
+        char stem[256];
+        char path[1400];
+        normalize_path(normalizedDir, sizeof(normalizedDir), outDir);
+        header_stem(stem, sizeof(stem), headerName);
+        snprintf(path, sizeof(path), "%s/%s.delta.o", normalizedDir, stem);
+        ok = save_object(&w, path);
+    }
+    if (ok)
+    {
+        printf("Delta: %d variants encoded against a base, %llu -> %llu bytes (%.1f%%)\n", deltaCount,
+               (unsigned long long)rawTotal, (unsigned long long)storedTotal,
+               rawTotal ? 100.0 * storedTotal / rawTotal : 0.0);
+    }
+
+    free_writer(&w);
+    for (int i = 0; i < total; i++)
+        free(payloads[i]);
+    free(payloads);
+    free(sizes);
+    free(fileOf);
+    free(assetOf);
+    free(groupOf);
+    free(keys);
+    return ok;
+}
+
+// 把所有输入对象的资源合并为一个可重定位对象：资源数据按对齐连续存放，保留每个 _start/_end/_size 符号；
+// --dedup 时重复资源的符号直接指向规范资源的数据，只存放一份。链接一个对象比链接成千上万个小对象快得多。
+// 有 --order-profile 时资源数据跨文件按访问顺序存放
+static int merge_objects(const char *path, const ObjectFile *files, int fileCount, const Options *opts)
+{
+    for (int f = 1; f < fileCount; f++)
+    {
+        if (files[f].format != files[0].format || files[f].machine != files[0].machine)
+        {
+            fprintf(stderr, "Cannot merge '%s' and '%s': object format or machine differs\n", files[0].filepath,
+                    files[f].filepath);
+            return 0;
+        }
+    }
+
+    int total = 0;
+    for (int f = 0; f < fileCount; f++)
+        total += files[f].assetCount;
+    int *placedSection = malloc((total ? total : 1) * sizeof(int));
+    uint32_t *placedOffset = malloc((total ? total : 1) * sizeof(uint32_t));
+    uint64_t *placedSize = malloc((total ? total : 1) * sizeof(uint64_t));
+    int *fileOf = malloc((total ? total : 1) * sizeof(int));
+    int *firstAsset = malloc(fileCount * sizeof(int)); // 每个文件第一个资源的全局下标
+    RankKey *keys = malloc((total ? total : 1) * sizeof(RankKey));
+    if (!placedSection || !placedOffset || !placedSize || !fileOf || !firstAsset || !keys)
+    {
+        fprintf(stderr, "Memory allocation failed for merged object\n");
+        free(placedSection);
+        free(placedOffset);
+        free(placedSize);
+        free(fileOf);
+        free(firstAsset);
+        free(keys);
+        return 0;
+    }
+
+    rank_all_assets(files, fileCount, keys, fileOf, firstAsset);
+
+    const char *sectionName = opts->assetSection ? opts->assetSection
+                              : files[0].format == FORMAT_COFF ? ".rdata" : ".rodata";
+    ObjWriter w;
+    writer_init(&w, files[0].format, files[0].machine);
+    int shared = -1;
+    int sharedBss = -1;
+    int ok = 1;
+    int merged = 0;
+    int aliases = 0;
+    uint64_t bytes = 0;
+    for (int k = 0; k < total && ok; k++)
+    {
+        int n = keys[k].index;
+        int f = fileOf[n];
+        const Asset *asset = &files[f].assets[n - firstAsset[f]];
+        if (asset->aliasFile)
+            continue;
+
+        unsigned char *data;
+        size_t dataSize;
+        if (!read_asset_payload(&files[f], asset, &data, &dataSize))
+        {
+            fprintf(stderr, "Cannot read payload of '%s' for merging\n", asset->base);
+            ok = 0;
+            break;
+        }
+        // 对齐取 --align、--spirv 和原节对齐中的最大值
+        const Section *source = symbol_section(&files[f], &files[f].symbols[asset->start]);
+        uint32_t align = opts->assetAlign;
+        if ((uint32_t)opts->spirvAlign > align)
+            align = (uint32_t)opts->spirvAlign;
+        if (source && source->align > align && source->align <= 8192)
+            align = source->align;
+
+        int zero = (source && source->nobits) || (opts->zeroBss && dataSize > 0 && is_all_zero(data, dataSize));
+        int sec = zero ? writer_asset_section(&w, &sharedBss, ".bss", asset->base, align, opts)
+                       : writer_asset_section(&w, &shared, sectionName, asset->base, align, opts);
+        int64_t placed = sec >= 0 ? writer_append(&w, sec, data, dataSize, align) : -1;
+        free(data);
+        if (placed < 0)
+        {
+            ok = 0;
+            break;
+        }
+        w.sections[sec].nobits = zero;
+        placedSection[n] = sec;
+        placedOffset[n] = (uint32_t)placed;
+        placedSize[n] = dataSize;
+        bytes += dataSize;
+        merged++;
+    }
+
+    // 符号按文件顺序输出，重复资源的符号指向规范资源的数据
+    for (int f = 0, n = 0; f < fileCount && ok; f++)
+    {
+        for (int a = 0; a < files[f].assetCount && ok; a++, n++)
+        {
+            const Asset *asset = &files[f].assets[a];
+            int placedAt = n;
+            uint64_t size = placedSize[n];
+            if (asset->aliasFile)
+            {
+                placedAt = firstAsset[asset->aliasFile - files] + asset->aliasAsset;
+                size = placedSize[placedAt];
+                aliases++;
+            }
+
+            char name[600];
+            int sec = placedSection[placedAt];
+            uint32_t offset = placedOffset[placedAt];
+            snprintf(name, sizeof(name), "%s_start", asset->base);
+            ok = writer_add_symbol(&w, name, sec, offset);
+            snprintf(name, sizeof(name), "%s_end", asset->base);
+            ok = ok && writer_add_symbol(&w, name, sec, (uint32_t)(offset + size));
+            snprintf(name, sizeof(name), "%s_size", asset->base);
+            ok = ok && writer_add_symbol(&w, name, -1, (uint32_t)size);
+        }
+    }
+
+    if (ok)
+    {
+        printf("Merged %d payloads from %d objects (%llu bytes, %d duplicates shared)\n", merged, fileCount,
+               (unsigned long long)bytes, aliases);
+        ok = save_object(&w, path);
+    }
+    free_writer(&w);
+    free(placedSection);
+    free(placedOffset);
+    free(placedSize);
+    free(fileOf);
+    free(firstAsset);
+    free(keys);
+    return ok;
+}
+
+// 资源包文件头（64 字节）：之后是按名称哈希排序的定长索引，再之后是按 PACK_ALIGN 对齐的资源数据；
+// 与对象文件一样按主机字节序（小端）写出
+typedef struct
+{
+    char magic[4]; // "SGPK"
+    uint32_t version;
+    uint32_t count;
+    uint32_t align;
+    uint64_t indexOffset;
+    uint64_t dataOffset;
+    uint64_t fileSize;
+    uint64_t reserved[3];
+} PackHeader;
+
+typedef struct
+{
+    uint64_t hash; // 资源标识符的 XXH64
+    uint64_t offset;
+    uint64_t size;
+} PackEntry;
+
+// 排序用的索引项，附带所属的资源以便报告名称冲突
+typedef struct
+{
+    PackEntry entry;
+    int file;
+    int asset;
+} PackSlot;
+
+static int compare_pack_slots(const void *a, const void *b)
+{
+    const PackSlot *x = a;
+    const PackSlot *y = b;
+    if (x->entry.hash != y->entry.hash)
+        return x->entry.hash < y->entry.hash ? -1 : 1;
+    return x->file != y->file ? x->file - y->file : x->asset - y->asset;
+}
+
+// 把所有资源数据写入一个资源包文件，运行时 mmap 整个文件即可按名称哈希查找资源，
+// 资源变化时不需要重新链接。--dedup 时重复资源共享同一份数据，有 --order-profile 时数据按访问顺序存放；
+// 每个资源在包中的偏移记录在 packOffset 中，供头文件输出
+static int write_pack(const char *path, ObjectFile *files, int fileCount, const Options *opts)
+{
+    int total = 0;
+    for (int f = 0; f < fileCount; f++)
+        total += files[f].assetCount;
+    int *fileOf = malloc((total ? total : 1) * sizeof(int));
+    int *firstAsset = malloc(fileCount * sizeof(int));
+    RankKey *keys = malloc((total ? total : 1) * sizeof(RankKey));
+    PackSlot *slots = malloc((total ? total : 1) * sizeof(PackSlot));
+    if (!fileOf || !firstAsset || !keys || !slots)
+    {
+        fprintf(stderr, "Memory allocation failed for asset pack\n");
+        free(fileOf);
+        free(firstAsset);
+        free(keys);
+        free(slots);
+        return 0;
+    }
+    rank_all_assets(files, fileCount, keys, fileOf, firstAsset);
+
+    // 索引包含所有可读取数据的资源，重复资源单独占一项但指向规范资源的数据
+    int count = 0;
+    for (int f = 0; f < fileCount; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            if (files[f].assets[a].start < 0)
+                continue;
+            char ident[256];
+            asset_ident(&files[f], a, ident, sizeof(ident));
+            slots[count].entry.hash = xxh64(ident, strlen(ident), 0);
+            slots[count].file = f;
+            slots[count].asset = a;
+            count++;
+        }
+    }
+    qsort(slots, count, sizeof(PackSlot), compare_pack_slots);
+    for (int k = 1; k < count; k++)
+    {
+        if (slots[k].entry.hash == slots[k - 1].entry.hash)
+        {
+            char ident[256];
+            asset_ident(&files[slots[k].file], slots[k].asset, ident, sizeof(ident));
+            fprintf(stderr, "Cannot pack '%s' and '%s': both are named '%s'\n", files[slots[k - 1].file].filepath,
+                    files[slots[k].file].filepath, ident);
+            free(fileOf);
+            free(firstAsset);
+            free(keys);
+            free(slots);
+            return 0;
+        }
+    }
+
+    uint32_t align = PACK_ALIGN;
+    if (opts->assetAlign > align)
+        align = opts->assetAlign;
+    if ((uint32_t)opts->spirvAlign > align)
+        align = (uint32_t)opts->spirvAlign;
+
+    PackHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "SGPK", 4);
+    header.version = PACK_VERSION;
+    header.count = (uint32_t)count;
+    header.align = align;
+    header.indexOffset = sizeof(PackHeader);
+    header.dataOffset = (header.indexOffset + (uint64_t)count * sizeof(PackEntry) + align - 1) & ~(uint64_t)(align - 1);
+
+    FILE *out = open_output(path);
+    if (!out)
+    {
+        free(fileOf);
+        free(firstAsset);
+        free(keys);
+        free(slots);
+        return 0;
+    }
+
+    // 先写数据确定每个资源的偏移，最后回到开头写文件头和索引；写入位置用 64 位计数器跟踪，
+    // 不依赖 ftell（LLP64 平台上 long 只有 32 位，超过 2 GiB 的资源包偏移会出错）
+    uint64_t pos = 0;
+    int ok = pad_output(out, &pos, header.dataOffset);
+    int packed = 0;
+    uint64_t bytes = 0;
+    for (int k = 0; k < total && ok; k++)
+    {
+        int n = keys[k].index;
+        int f = fileOf[n];
+        Asset *asset = &files[f].assets[n - firstAsset[f]];
+        if (asset->aliasFile || asset->start < 0)
+            continue;
+
+        unsigned char *data;
+        size_t dataSize;
+        if (!read_asset_payload(&files[f], asset, &data, &dataSize))
+        {
+            fprintf(stderr, "Cannot read payload of '%s' for packing\n", asset->base);
+            ok = 0;
+            break;
+        }
+        ok = pad_output(out, &pos, (pos + align - 1) & ~(uint64_t)(align - 1));
+        asset->packOffset = (int64_t)pos;
+        if (ok && dataSize > 0 && fwrite(data, 1, dataSize, out) != dataSize)
+            ok = 0;
+        pos += dataSize;
+        free(data);
+        bytes += dataSize;
+        packed++;
+    }
+    header.fileSize = pos;
+
+    for (int f = 0; f < fileCount && ok; f++)
+    {
+        for (int a = 0; a < files[f].assetCount; a++)
+        {
+            Asset *asset = &files[f].assets[a];
+            if (asset->aliasFile)
+            {
+                const ObjectFile *target = &files[f];
+                asset->packOffset = canonical_asset(&target, asset)->packOffset;
+            }
+        }
+    }
+    for (int k = 0; k < count && ok; k++)
+    {
+        const ObjectFile *file = &files[slots[k].file];
+        const Asset *asset = &file->assets[slots[k].asset];
+        uint64_t size = 0;
+        asset_size(file, asset, &size);
+        slots[k].entry.offset = (uint64_t)asset->packOffset;
+        slots[k].entry.size = size;
+    }
+
+    if (ok)
+    {
+        fseek(out, 0, SEEK_SET);
+        ok = fwrite(&header, sizeof(header), 1, out) == 1;
+        for (int k = 0; k < count && ok; k++)
+            ok = fwrite(&slots[k].entry, sizeof(PackEntry), 1, out) == 1;
+    }
+    int status = -1;
+    if (ok)
+    {
+        status = close_output(out, path);
+    }
+    else
+    {
+        // 写入失败时丢弃临时文件，保留原来的资源包
+        char tmpPath[1100];
+        fprintf(stderr, "Error writing asset pack '%s': %s\n", path, strerror(errno));
+        fclose(out);
+        snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+        remove(tmpPath);
+    }
+    if (status >= 0)
+    {
+        printf("Packed %d payloads into %d index entries (%llu bytes of data)\n", packed, count,
+               (unsigned long long)bytes);
+        report_output(status, "asset pack", path);
+    }
+    free(fileOf);
+    free(firstAsset);
+    free(keys);
+    free(slots);
+    return status >= 0;
+}
+
+// 链接脚本中资源区域的对齐：2 MiB，整个区域可以由透明大页支撑
+#define LINKER_SCRIPT_ALIGN 0x200000
+
+// --linker-order 的排列方式
+enum
+{
+    LINKER_ORDER_INPUT = 0,
+    LINKER_ORDER_NAME,
+    LINKER_ORDER_SIZE
+};
+
+// 链接脚本中的一项：某个对象中存放资源的一个节
+typedef struct
+{
+    const ObjectFile *file;
+    int section;
+    const char *name;   // 节中第一个资源改名前的符号前缀，用于按名称排序（--short-names 不影响顺序）
+    const char *symbol; // 节中第一个资源当前的符号前缀，写入注释
+    uint32_t size;
+    unsigned int rank; // 节中资源在 --order-profile 中最早的位置，没有列出时为最大值
+    int order;         // 输入顺序，排序相同时保持稳定
+} ScriptEntry;
+
+static int compare_script_by_rank(const void *a, const void *b)
+{
+    const ScriptEntry *x = a;
+    const ScriptEntry *y = b;
+    if (x->rank != y->rank)
+        return x->rank < y->rank ? -1 : 1;
+    return x->order - y->order;
+}
+
+static int compare_script_by_name(const void *a, const void *b)
+{
+    const ScriptEntry *x = a;
+    const ScriptEntry *y = b;
+    int cmp = strcmp(x->name, y->name);
+    return cmp ? cmp : x->order - y->order;
+}
+
+// 按大小从大到小，大资源先占据整页，小资源集中在区域末尾
+static int compare_script_by_size(const void *a, const void *b)
+{
+    const ScriptEntry *x = a;
+    const ScriptEntry *y = b;
+    if (x->size != y->size)
+        return x->size > y->size ? -1 : 1;
+    return x->order - y->order;
+}
+
+// 节是否可写：ELF 的 SHF_WRITE / COFF 的 IMAGE_SCN_MEM_WRITE
+static int section_writable(const ObjectFile *file, const Section *section)
+{
+    if (file->format == FORMAT_ELF)
+        return (section->flags & 1) != 0;
+    return (section->flags & 0x80000000u) != 0;
+}
+
+// 生成 GNU ld / lld 链接脚本片段 <outDir>/<stem>.ld：把所有输入中存放资源的节按指定顺序收集到一个
+// 起始地址按 2 MiB 对齐的输出节 .<stem>_assets 中（插入在 .rodata 之后），启动时可以顺序读入并由透明大页支撑；
+// 结尾不补齐，避免文件多出最多 2 MiB 的填充。无数据的节（.bss）不收集，否则会在文件中展开为零；
+// 可写的节会让整个输出节落入可写段，给出警告
+static void generate_linker_script(const char *outDir, const char *headerName, const ObjectFile *files, int fileCount,
+                                   const Options *opts)
+{
+    int capacity = 0;
+    for (int f = 0; f < fileCount; f++)
+        capacity += files[f].sectionCount;
+    ScriptEntry *entries = malloc((capacity ? capacity : 1) * sizeof(ScriptEntry));
+    unsigned char *marked = malloc(capacity ? capacity : 1);
+    if (!entries || !marked)
+    {
+        fprintf(stderr, "Memory allocation failed for linker script\n");
+        free(entries);
+        free(marked);
+        return;
+    }
+
+    int count = 0;
+    for (int f = 0; f < fileCount; f++)
+    {
+        mark_asset_sections(&files[f], marked);
+        for (int s = 0; s < files[f].sectionCount; s++)
+        {
+            if (!marked[s] || files[f].sections[s].nobits)
+                continue;
+            if (section_writable(&files[f], &files[f].sections[s]))
+            {
+                fprintf(stderr, "Warning: section '%s' of '%s' is writable; the linker script would place all assets "
+                                "in a writable segment (use --rewrite-rodata)\n",
+                        files[f].sections[s].name, files[f].filepath);
+            }
+            ScriptEntry *entry = &entries[count];
+            entry->file = &files[f];
+            entry->section = s;
+            entry->name = "";
+            entry->symbol = "";
+            entry->size = files[f].sections[s].size;
+            entry->rank = (unsigned int)-1;
+            entry->order = count;
+            for (int a = 0; a < files[f].assetCount; a++)
+            {
+                const Asset *asset = &files[f].assets[a];
+                if (asset->start < 0 ||
+                    symbol_section(&files[f], &files[f].symbols[asset->start]) != &files[f].sections[s])
+                    continue;
+                if (!entry->name[0])
+                {
+                    entry->name = asset->origBase ? asset->origBase : asset->base;
+                    entry->symbol = asset->base;
+                }
+                if ((unsigned int)asset->rank < entry->rank)
+                    entry->rank = (unsigned int)asset->rank;
+            }
+            count++;
+        }
+    }
+    if (opts->linkerOrder == LINKER_ORDER_INPUT && opts->orderProfile)
+        qsort(entries, count, sizeof(ScriptEntry), compare_script_by_rank);
+    else if (opts->linkerOrder == LINKER_ORDER_NAME)
+        qsort(entries, count, sizeof(ScriptEntry), compare_script_by_name);
+    else if (opts->linkerOrder == LINKER_ORDER_SIZE)
+        qsort(entries, count, sizeof(ScriptEntry), compare_script_by_size);
+
+    char normalizedDir[1024];
+    char stem[256];
+    char path[1400];
+    char ident[256];
+    normalize_path(normalizedDir, sizeof(normalizedDir), outDir);
+    header_stem(stem, sizeof(stem), headerName);
+    snprintf(path, sizeof(path), "%s/%s.ld", normalizedDir, stem);
+    header_guard_name(ident, sizeof(ident), headerName);
+    to_lowercase(ident);
+
+    FILE *f = open_output(path);
+    if (!f)
+    {
+        free(entries);
+        free(marked);
+        return;
+    }
+    fprintf(f, "/* Auto-generated linker script fragment: %d asset sections from %d object files */\n", count,
+            fileCount);
+    fprintf(f, "/* Pass it with -Wl,-T,%s.ld; link with -z max-page-size=0x%x for file-backed huge pages */\n", stem,
+            LINKER_SCRIPT_ALIGN);
+    fprintf(f, "SECTIONS\n{\n");
+    fprintf(f, "    .%s_assets ALIGN(0x%x) :\n    {\n", ident, LINKER_SCRIPT_ALIGN);
+    fprintf(f, "        __%s_assets_start = .;\n", ident);
+    for (int e = 0; e < count; e++)
     {
-        fprintf(stderr, "Usage: %s -d <output_dir> [-n <header_name>] <file1.o> [macro1] <file2.o> [macro2] ...\n", argv[0]);
+        // 链接器按命令行上给出的文件名匹配，同时匹配带目录和不带目录的写法；不含通配符的文件名会被当作
+        // 额外的输入文件加载，因此不带目录的写法把首字符写成 [c] 形式
+        const ScriptEntry *entry = &entries[e];
+        const char *object = entry->file->filepath;
+        const char *slash = strrchr(object, '/');
+        if (!slash)
+            slash = strrchr(object, '\\');
+        const char *name = slash ? slash + 1 : object;
+        const char *section = entry->file->sections[entry->section].name;
+        fprintf(f, "        /* %s, %u bytes */\n", entry->symbol, entry->size);
+        fprintf(f, "        */%s(%s)\n", name, section);
+        fprintf(f, "        [%c]%s(%s)\n", name[0], name + 1, section);
+    }
+    fprintf(f, "        __%s_assets_end = .;\n", ident);
+    fprintf(f, "    }\n}\nINSERT AFTER .rodata;\n");
+
+    int status = close_output(f, path);
+    report_output(status, "linker script", path);
+    free(entries);
+    free(marked);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "Usage: %s -d <output_dir> [-n <header_name>] [options] <file1.o> [macro1[:strip]] <file2.o> [macro2[:strip]] ...\n", argv[0]);
         fprintf(stderr, "If -n is specified, all symbols are combined into one header file.\n");
         fprintf(stderr, "Otherwise, each .o file gets its own header.\n");
+        fprintf(stderr, "Inputs that are not ELF/COFF objects (by file header) are embedded directly into <output_dir>/<name>.o.\n");
+        fprintf(stderr, "Options:\n");
+        fprintf(stderr, "  --lang=c|c++          Output language (c++ adds std::span/std::string_view accessors)\n");
+        fprintf(stderr, "  --namespace=<name>    Namespace for C++ accessors (default: assets)\n");
+        fprintf(stderr, "  --enum                Emit an asset ID enum and ID-indexed start/end/size arrays (requires -n)\n");
+        fprintf(stderr, "  --xmacro              Emit an ASSET_LIST(X) X-macro over all assets (requires -n)\n");
+        fprintf(stderr, "  --shard-by=dir|count:N  Split the combined header by source directory or N files per shard,\n");
+        fprintf(stderr, "                        plus an umbrella header and an index header (requires -n)\n");
+        fprintf(stderr, "  --spirv[=ALIGN]       Declare payloads as ALIGN-aligned uint32_t SPIR-V code (default 4)\n");
+        fprintf(stderr, "                        and emit VkShaderModuleCreateInfo initializers\n");
+        fprintf(stderr, "  --reflect             Emit entry point, stage and descriptor binding constants for SPIR-V payloads\n");
+        fprintf(stderr, "  --hash                Emit an XXH64 content hash constant per asset\n");
+        fprintf(stderr, "  --chunk-size=N        Emit a table of N-byte chunks (offset, size, XXH64) for large assets\n");
+        fprintf(stderr, "                        (power of two from 256, default 65536)\n");
+        fprintf(stderr, "  --chunk-threshold=N   Only assets larger than N bytes get a chunk table (default: the chunk size)\n");
+        fprintf(stderr, "  --dedup               Alias byte-identical payloads to one canonical symbol (requires -n)\n");
+        fprintf(stderr, "  --prefetch            Emit static inline madvise(WILLNEED) prefetch helpers per asset and per header\n");
+        fprintf(stderr, "  --hot <a,b,...>       Emit a preload_hot() function for the listed assets (implies --prefetch)\n");
+        fprintf(stderr, "  --compress            Write LZ4-compressed payloads to <name>.lz4.o and emit <name>_decompress() accessors\n");
+        fprintf(stderr, "  --compress-dict[=SIZE]  Also train a shared dictionary of up to SIZE bytes (default 32768, requires -n)\n");
+        fprintf(stderr, "  --delta               Store variants as copy/insert deltas against a per-group base in <name>.delta.o\n");
+        fprintf(stderr, "                        and emit <name>_reconstruct() accessors (requires -n)\n");
+        fprintf(stderr, "  --delta-group-by=dir|all  Pick one base per source directory or across all inputs (default: all)\n");
+        fprintf(stderr, "  --strip-spirv         Strip OpSource/OpName/OpLine and other debug instructions from SPIR-V payloads\n");
+        fprintf(stderr, "                        into <name>.stripped.o (per input: append :strip to the macro)\n");
+        fprintf(stderr, "  --rewrite-rodata      Make the writable .data sections holding payloads read-only (.rodata / .rdata)\n");
+        fprintf(stderr, "                        in the patched object <name>.patched.o\n");
+        fprintf(stderr, "  --zero-bss            Emit all-zero payloads as .bss and convert all-zero payload sections of input\n");
+        fprintf(stderr, "                        objects to NOBITS / uninitialized data in <name>.patched.o\n");
+        fprintf(stderr, "  --short-names[=macro|hash]  Rename _binary_ symbols to _binary_<macro> (default) or _binary_<xxh64>\n");
+        fprintf(stderr, "                        to shrink string tables; headers use the new names\n");
+        fprintf(stderr, "  --merge-out <file.o>  Also write all payloads and _binary_ symbols into one relocatable object\n");
+        fprintf(stderr, "                        (duplicates stored once with --dedup, requires -n)\n");
+        fprintf(stderr, "  --pack <file>         Also write all payloads into one 64-byte-aligned pack file with a sorted\n");
+        fprintf(stderr, "                        (name hash, offset, size) index and emit pack IDs and offsets (requires -n)\n");
+        fprintf(stderr, "  --lazy                Emit <name>_data() accessors resolving once to the pack mapped at runtime\n");
+        fprintf(stderr, "                        or to the embedded symbols (requires --pack)\n");
+        fprintf(stderr, "  --linker-script       Emit <name>.ld, a GNU ld / lld fragment gathering all asset sections into one\n");
+        fprintf(stderr, "                        2 MiB-aligned output section after .rodata (requires -n)\n");
+        fprintf(stderr, "  --linker-order=input|name|size  Order of sections in the linker script (default: input;\n");
+        fprintf(stderr, "                        size puts the largest first; implies --linker-script)\n");
+        fprintf(stderr, "  --order-profile <file>  Order headers, registry, merged object and linker script by a runtime\n");
+        fprintf(stderr, "                        first-touch profile (one asset name per line)\n");
+        fprintf(stderr, "  --realign=N           Raise the alignment of the sections holding payloads in input objects to N\n");
+        fprintf(stderr, "                        (power of two up to 8192) in the patched object <name>.patched.o\n");
+        fprintf(stderr, "  --format=elf|coff     Object format for raw (non-object) inputs (default: host format)\n");
+        fprintf(stderr, "  --align=N             Payload alignment in generated objects (default 16)\n");
+        fprintf(stderr, "  --section=NAME        Section for payloads in generated objects (default .rodata / .rdata)\n");
+        fprintf(stderr, "  --section-per-asset   Put each asset in its own section in generated objects (.rodata.asset.<name>,\n");
+        fprintf(stderr, "                        COMDAT on COFF) so --gc-sections / /OPT:REF can drop unused assets\n");
+        fprintf(stderr, "  --deterministic       Sort symbols and keep headers independent of the checkout path\n");
+        fprintf(stderr, "  --prefix-map=OLD=NEW  Remap path prefixes in generated comments (repeatable)\n");
         return 1;
     }
 
     const char *outDir = NULL;
     const char *outName = NULL;
+    // 只列出非零的默认值，其余成员为 0 / NULL，新增选项时不需要对照成员顺序
+    Options opts = {
+        .lang = LANG_C,
+        .cppNamespace = "assets",
+        .shardBy = SHARD_NONE,
+        .linkerOrder = LINKER_ORDER_INPUT,
+        .rawFormat = HOST_FORMAT,
+        .assetAlign = 16,
+    };
+    const char **prefixMaps = malloc(argc * sizeof(const char *));
+    if (!prefixMaps)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
+    }
+    opts.prefixMaps = prefixMaps;
+    int chunkThresholdSet = 0;
     int i = 1;
     while (i < argc)
     {
@@ -852,6 +6681,333 @@ int main(int argc, char **argv)
             outName = argv[i + 1];
             i += 2;
         }
+        else if (strncmp(argv[i], "--lang=", 7) == 0)
+        {
+            const char *lang = argv[i] + 7;
+            if (strcmp(lang, "c") == 0)
+            {
+                opts.lang = LANG_C;
+            }
+            else if (strcmp(lang, "c++") == 0 || strcmp(lang, "cpp") == 0)
+            {
+                opts.lang = LANG_CPP;
+            }
+            else
+            {
+                fprintf(stderr, "Unknown language '%s' (expected c or c++)\n", lang);
+                return 1;
+            }
+            i++;
+        }
+        else if (strncmp(argv[i], "--namespace=", 12) == 0)
+        {
+            opts.cppNamespace = argv[i] + 12;
+            if (!opts.cppNamespace[0])
+            {
+                fprintf(stderr, "Empty namespace for --namespace\n");
+                return 1;
+            }
+            i++;
+        }
+        else if (strcmp(argv[i], "--enum") == 0)
+        {
+            opts.registry = 1;
+            i++;
+        }
+        else if (strcmp(argv[i], "--xmacro") == 0)
+        {
+            opts.xmacro = 1;
+            i++;
+        }
+        else if (strncmp(argv[i], "--shard-by=", 11) == 0)
+        {
+            const char *mode = argv[i] + 11;
+            if (strcmp(mode, "dir") == 0)
+            {
+                opts.shardBy = SHARD_BY_DIR;
+            }
+            else if (strncmp(mode, "count:", 6) == 0 && atoi(mode + 6) > 0)
+            {
+                opts.shardBy = SHARD_BY_COUNT;
+                opts.shardCount = atoi(mode + 6);
+            }
+            else
+            {
+                fprintf(stderr, "Invalid shard mode '%s' (expected dir or count:N)\n", mode);
+                return 1;
+            }
+            i++;
+        }
+        else if (strcmp(argv[i], "--spirv") == 0 || strncmp(argv[i], "--spirv=", 8) == 0)
+        {
+            opts.spirvAlign = argv[i][7] == '=' ? atoi(argv[i] + 8) : 4;
+            if (opts.spirvAlign < 4 || (opts.spirvAlign & (opts.spirvAlign - 1)) != 0)
+            {
+                fprintf(stderr, "Invalid SPIR-V alignment '%s' (expected a power of two >= 4)\n", argv[i] + 8);
+                return 1;
+            }
+            i++;
+        }
+        else if (strcmp(argv[i], "--reflect") == 0)
+        {
+            opts.reflect = 1;
+            i++;
+        }
+        else if (strcmp(argv[i], "--hash") == 0)
+        {
+            opts.hash = 1;
+            i++;
+        }
+        else if (strncmp(argv[i], "--chunk-size=", 13) == 0)
+        {
+            long size = atol(argv[i] + 13);
+            if (size < 256 || size > 0x40000000L || (size & (size - 1)) != 0)
+            {
+                fprintf(stderr, "Invalid chunk size '%s' (expected a power of two from 256 to 1 GiB)\n", argv[i] + 13);
+                return 1;
+            }
+            opts.chunkSize = (uint32_t)size;
+            i++;
+        }
+        else if (strncmp(argv[i], "--chunk-threshold=", 18) == 0)
+        {
+            char *end;
+            opts.chunkThreshold = strtoull(argv[i] + 18, &end, 10);
+            if (end == argv[i] + 18 || *end)
+            {
+                fprintf(stderr, "Invalid chunk threshold '%s' (expected a byte count)\n", argv[i] + 18);
+                return 1;
+            }
+            chunkThresholdSet = 1;
+            i++;
+        }
+        else if (strcmp(argv[i], "--dedup") == 0)
+        {
+            opts.dedup = 1;
+            i++;
+        }
+        else if (strcmp(argv[i], "--prefetch") == 0)
+        {
+            opts.prefetch = 1;
+            i++;
+        }
+        else if (strcmp(argv[i], "--hot") == 0)
+        {
+            if (i + 1 >= argc || !argv[i + 1][0])
+            {
+                fprintf(stderr, "Missing argument for --hot\n");
+                return 1;
+            }
+            opts.hotList = argv[i + 1];
+            opts.prefetch = 1;
+            i += 2;
+        }
+        else if (strcmp(argv[i], "--compress") == 0)
+        {
+            opts.compress = 1;
+            i++;
+        }
+        else if (strcmp(argv[i], "--compress-dict") == 0 || strncmp(argv[i], "--compress-dict=", 16) == 0)
+        {
+            opts.compressDict = argv[i][15] == '=' ? atoi(argv[i] + 16) : 32768;
+            if (opts.compressDict < DICT_BLOCK || opts.compressDict > LZ4_MAX_OFFSET)
+            {
+                fprintf(stderr, "Invalid dictionary size '%s' (expected %d..%d bytes)\n", argv[i] + 16, DICT_BLOCK,
+                        LZ4_MAX_OFFSET);
+                return 1;
+            }
+            opts.compress = 1;
+            i++;
+        }
+        else if (strcmp(argv[i], "--delta") == 0)
+        {
+            opts.delta = 1;
+            i++;
+        }
+        else if (strncmp(argv[i], "--delta-group-by=", 17) == 0)
+        {
+            const char *mode = argv[i] + 17;
+            if (strcmp(mode, "dir") != 0 && strcmp(mode, "all") != 0)
+            {
+                fprintf(stderr, "Invalid delta grouping '%s' (expected dir or all)\n", mode);
+                return 1;
+            }
+            opts.delta = 1;
+            opts.deltaByDir = strcmp(mode, "dir") == 0;
+            i++;
+        }
+        else if (strcmp(argv[i], "--strip-spirv") == 0)
+        {
+            opts.stripSpirv = 1;
+            i++;
+        }
+        else if (strcmp(argv[i], "--rewrite-rodata") == 0)
+        {
+            opts.rewriteRodata = 1;
+            i++;
+        }
+        else if (strcmp(argv[i], "--zero-bss") == 0)
+        {
+            opts.zeroBss = 1;
+            i++;
+        }
+        else if (strcmp(argv[i], "--short-names") == 0 || strncmp(argv[i], "--short-names=", 14) == 0)
+        {
+            const char *mode = argv[i][13] == '=' ? argv[i] + 14 : "macro";
+            if (strcmp(mode, "macro") == 0)
+            {
+                opts.shortNames = SHORT_NAMES_MACRO;
+            }
+            else if (strcmp(mode, "hash") == 0)
+            {
+                opts.shortNames = SHORT_NAMES_HASH;
+            }
+            else
+            {
+                fprintf(stderr, "Invalid naming mode '%s' (expected macro or hash)\n", mode);
+                return 1;
+            }
+            i++;
+        }
+        else if (strcmp(argv[i], "--merge-out") == 0)
+        {
+            if (i + 1 >= argc || !argv[i + 1][0])
+            {
+                fprintf(stderr, "Missing argument for --merge-out\n");
+                return 1;
+            }
+            opts.mergeOut = argv[i + 1];
+            i += 2;
+        }
+        else if (strcmp(argv[i], "--pack") == 0)
+        {
+            if (i + 1 >= argc || !argv[i + 1][0])
+            {
+                fprintf(stderr, "Missing argument for --pack\n");
+                return 1;
+            }
+            opts.pack = argv[i + 1];
+            i += 2;
+        }
+        else if (strcmp(argv[i], "--lazy") == 0)
+        {
+            opts.lazy = 1;
+            i++;
+        }
+        else if (strcmp(argv[i], "--linker-script") == 0)
+        {
+            opts.linkerScript = 1;
+            i++;
+        }
+        else if (strncmp(argv[i], "--linker-order=", 15) == 0)
+        {
+            const char *order = argv[i] + 15;
+            if (strcmp(order, "input") == 0)
+            {
+                opts.linkerOrder = LINKER_ORDER_INPUT;
+            }
+            else if (strcmp(order, "name") == 0)
+            {
+                opts.linkerOrder = LINKER_ORDER_NAME;
+            }
+            else if (strcmp(order, "size") == 0)
+            {
+                opts.linkerOrder = LINKER_ORDER_SIZE;
+            }
+            else
+            {
+                fprintf(stderr, "Invalid linker order '%s' (expected input, name or size)\n", order);
+                return 1;
+            }
+            opts.linkerScript = 1;
+            i++;
+        }
+        else if (strcmp(argv[i], "--order-profile") == 0)
+        {
+            if (i + 1 >= argc || !argv[i + 1][0])
+            {
+                fprintf(stderr, "Missing argument for --order-profile\n");
+                return 1;
+            }
+            opts.orderProfile = argv[i + 1];
+            i += 2;
+        }
+        else if (strncmp(argv[i], "--realign=", 10) == 0)
+        {
+            int align = atoi(argv[i] + 10);
+            if (align < 1 || align > 8192 || (align & (align - 1)) != 0)
+            {
+                fprintf(stderr, "Invalid alignment '%s' (expected a power of two up to 8192)\n", argv[i] + 10);
+                return 1;
+            }
+            opts.realign = (uint32_t)align;
+            i++;
+        }
+        else if (strcmp(argv[i], "--section-per-asset") == 0)
+        {
+            opts.sectionPerAsset = 1;
+            i++;
+        }
+        else if (strncmp(argv[i], "--format=", 9) == 0)
+        {
+            const char *format = argv[i] + 9;
+            if (strcmp(format, "elf") == 0)
+            {
+                opts.rawFormat = FORMAT_ELF;
+            }
+            else if (strcmp(format, "coff") == 0)
+            {
+                opts.rawFormat = FORMAT_COFF;
+            }
+            else
+            {
+                fprintf(stderr, "Unknown object format '%s' (expected elf or coff)\n", format);
+                return 1;
+            }
+            i++;
+        }
+        else if (strncmp(argv[i], "--align=", 8) == 0)
+        {
+            int align = atoi(argv[i] + 8);
+            if (align < 1 || align > 8192 || (align & (align - 1)) != 0)
+            {
+                fprintf(stderr, "Invalid alignment '%s' (expected a power of two up to 8192)\n", argv[i] + 8);
+                return 1;
+            }
+            opts.assetAlign = (uint32_t)align;
+            i++;
+        }
+        else if (strncmp(argv[i], "--section=", 10) == 0)
+        {
+            opts.assetSection = argv[i] + 10;
+            if (!opts.assetSection[0])
+            {
+                fprintf(stderr, "Empty section name for --section\n");
+                return 1;
+            }
+            i++;
+        }
+        else if (strcmp(argv[i], "--deterministic") == 0)
+        {
+            opts.deterministic = 1;
+            i++;
+        }
+        else if (strncmp(argv[i], "--prefix-map=", 13) == 0)
+        {
+            const char *map = argv[i] + 13;
+            if (!strchr(map, '=') || map[0] == '=')
+            {
+                fprintf(stderr, "Invalid prefix map '%s' (expected OLD=NEW)\n", map);
+                return 1;
+            }
+            prefixMaps[opts.prefixMapCount++] = map;
+            i++;
+        }
+        else if (strncmp(argv[i], "--", 2) == 0)
+        {
+            fprintf(stderr, "Unknown option '%s'\n", argv[i]);
+            return 1;
+        }
         else
         {
             break;
@@ -864,6 +7020,35 @@ int main(int argc, char **argv)
         return 1;
     }
 
+    if ((opts.registry || opts.xmacro || opts.shardBy != SHARD_NONE || opts.dedup || opts.compressDict || opts.delta ||
+         opts.mergeOut || opts.pack || opts.linkerScript) &&
+        !outName)
+    {
+        fprintf(stderr, "%s requires a combined header (use -n)\n",
+                opts.registry ? "--enum" : opts.xmacro ? "--xmacro" : opts.dedup ? "--dedup"
+                : opts.compressDict ? "--compress-dict" : opts.delta ? "--delta"
+                : opts.mergeOut ? "--merge-out" : opts.pack ? "--pack" : opts.linkerScript ? "--linker-script" : "--shard-by");
+        return 1;
+    }
+
+    // 只给出阈值时使用默认块大小，只给出块大小时只有超过一块的资源生成分块表
+    if (chunkThresholdSet && !opts.chunkSize)
+        opts.chunkSize = 65536;
+    if (!chunkThresholdSet)
+        opts.chunkThreshold = opts.chunkSize;
+
+    if (opts.lazy && !opts.pack)
+    {
+        fprintf(stderr, "--lazy requires an asset pack (use --pack)\n");
+        return 1;
+    }
+
+    if (opts.compress && opts.delta)
+    {
+        fprintf(stderr, "--delta cannot be combined with --compress (deltas are already encoded)\n");
+        return 1;
+    }
+
     // 创建输出目录
     if (mkdir(outDir, 0755) != 0 && errno != EEXIST)
     {
@@ -884,23 +7069,83 @@ int main(int argc, char **argv)
     {
         const char *filepath = argv[i];
         i++;
+        // 下一个参数不是选项且不像路径（宏名不含 . / \）时作为宏名；没有扩展名的文件（如 LICENSE）
+        // 紧跟在另一个输入之后时也会被当作宏名，需要写成 ./LICENSE
         const char *macro = "";
-        if (i < argc && argv[i][0] != '-')
+        if (i < argc && argv[i][0] != '-' && !strpbrk(argv[i], "./\\"))
         {
             macro = argv[i];
             i++;
+            FILE *probe = fopen(macro, "rb");
+            if (probe)
+            {
+                fclose(probe);
+                fprintf(stderr, "Warning: '%s' is used as the macro name of '%s'; write './%s' to embed the file\n",
+                        macro, filepath, macro);
+            }
         }
 
-        files[fileCount].filepath = my_strdup(filepath);
+        // 宏名后可以带 ":strip" 为单个输入启用 SPIR-V 调试指令剥离
+        files[fileCount].stripSpirv = opts.stripSpirv;
         files[fileCount].macro = my_strdup(macro);
+        char *option = strchr(files[fileCount].macro, ':');
+        if (option)
+        {
+            if (strcmp(option + 1, "strip") != 0)
+            {
+                fprintf(stderr, "Unknown input option '%s' for '%s' (expected :strip)\n", option, filepath);
+                return 1;
+            }
+            *option = '\0';
+            files[fileCount].stripSpirv = 1;
+        }
+
+        // 原始文件先生成对象文件，之后按对象文件处理
+        const char *objectPath = filepath;
+        char rawObject[1400];
+        int built = 1;
+        if (is_raw_input(filepath))
+        {
+            raw_object_path(rawObject, sizeof(rawObject), outDir, filepath);
+            for (int g = 0; g < fileCount; g++)
+            {
+                if (strcmp(files[g].filepath, rawObject) == 0)
+                {
+                    fprintf(stderr, "Raw inputs '%s' and '%s' both map to '%s'\n", files[g].inputPath, filepath,
+                            rawObject);
+                    return 1;
+                }
+            }
+            built = build_raw_object(filepath, rawObject, &opts);
+            objectPath = rawObject;
+        }
+
+        files[fileCount].filepath = my_strdup(objectPath);
+        files[fileCount].inputPath = my_strdup(filepath);
         files[fileCount].symbols = NULL;
         files[fileCount].symbolCount = 0;
+        files[fileCount].assets = NULL;
+        files[fileCount].assetCount = 0;
+        files[fileCount].sections = NULL;
+        files[fileCount].sectionCount = 0;
 
-        if (!parse_object_file(filepath, &files[fileCount].symbols, &files[fileCount].symbolCount))
+        int parsed = built && parse_object_file(objectPath, &files[fileCount]);
+
+        // 确定性模式下按名称排序符号，消除不同工具链符号表顺序的差异
+        if (parsed && opts.deterministic)
+            qsort(files[fileCount].symbols, files[fileCount].symbolCount, sizeof(Symbol), compare_symbols);
+
+        if (!parsed || !collect_assets(&files[fileCount]) ||
+            (files[fileCount].stripSpirv && !strip_spirv_assets(outDir, &files[fileCount], &opts)) ||
+            ((opts.rewriteRodata || opts.zeroBss || opts.realign || opts.shortNames) && !patch_object(outDir, &files[fileCount], &opts)))
         {
             fprintf(stderr, "Failed to parse '%s', skipping\n", filepath);
             free(files[fileCount].filepath);
+            free(files[fileCount].inputPath);
             free(files[fileCount].macro);
+            free_symbols(files[fileCount].symbols, files[fileCount].symbolCount);
+            free_assets(files[fileCount].assets, files[fileCount].assetCount);
+            free_sections(files[fileCount].sections, files[fileCount].sectionCount);
             continue;
         }
 
@@ -911,22 +7156,98 @@ int main(int argc, char **argv)
     {
         fprintf(stderr, "No valid object files to process\n");
         free(files);
+        free(prefixMaps);
+        return 1;
+    }
+
+    // 先按访问顺序重排，去重时规范资源取最早访问的那个
+    if (opts.orderProfile && !order_assets_by_profile(opts.orderProfile, files, fileCount))
+    {
+        free(files);
+        free(prefixMaps);
+        return 1;
+    }
+
+    if (opts.spirvAlign && !check_spirv_alignment(files, fileCount, &opts))
+    {
+        free(files);
+        free(prefixMaps);
         return 1;
     }
 
-    // 生成头文件
-    if (outName)
+    if (opts.dedup)
+        dedup_assets(files, fileCount);
+
+    // 检查 --hot 中的名称，拼写错误的资源名只会让预加载悄悄失效
+    if (opts.hotList)
+    {
+        const char *p = opts.hotList;
+        while (*p)
+        {
+            const char *comma = strchr(p, ',');
+            size_t len = comma ? (size_t)(comma - p) : strlen(p);
+            char name[256];
+            snprintf(name, sizeof(name), "%.*s", (int)len, p);
+            int found = 0;
+            for (int f = 0; f < fileCount && !found; f++)
+                for (int a = 0; a < files[f].assetCount && !found; a++)
+                    found = asset_in_list(&files[f], a, name);
+            if (len > 0 && !found)
+                fprintf(stderr, "Warning: hot asset '%s' not found\n", name);
+            p += len;
+            if (*p == ',')
+                p++;
+        }
+    }
+
+    int status = 0;
+    if (opts.compress && !compress_assets(outDir, outName ? outName : "assets", files, fileCount, &opts))
+        status = 1;
+    if (status == 0 && opts.delta && !delta_encode_assets(outDir, outName, files, fileCount, &opts))
+        status = 1;
+    if (status == 0 && opts.mergeOut && !merge_objects(opts.mergeOut, files, fileCount, &opts))
+        status = 1;
+    if (status == 0 && opts.pack && !write_pack(opts.pack, files, fileCount, &opts))
+        status = 1;
+
+    // 链接脚本收集实际链接的对象中的节：合并时为合并后的对象
+    if (status == 0 && opts.linkerScript && opts.mergeOut)
+    {
+        ObjectFile merged;
+        memset(&merged, 0, sizeof(merged));
+        merged.filepath = my_strdup(opts.mergeOut);
+        merged.inputPath = my_strdup(opts.mergeOut);
+        if (parse_object_file(opts.mergeOut, &merged) && collect_assets(&merged))
+            generate_linker_script(outDir, outName, &merged, 1, &opts);
+        else
+            status = 1;
+        free(merged.filepath);
+        free(merged.inputPath);
+        free_symbols(merged.symbols, merged.symbolCount);
+        free_assets(merged.assets, merged.assetCount);
+        free_sections(merged.sections, merged.sectionCount);
+    }
+    else if (status == 0 && opts.linkerScript)
+    {
+        generate_linker_script(outDir, outName, files, fileCount, &opts);
+    }
+
+    // 生成头文件（压缩失败时不生成引用压缩符号的头文件）
+    if (status == 0 && outName)
     {
         // 合并模式
-        generate_combined_header(outDir, outName, files, fileCount);
+        if (opts.shardBy != SHARD_NONE)
+            generate_sharded_headers(outDir, outName, files, fileCount, &opts);
+        else
+            generate_combined_header(outDir, outName, files, fileCount, &opts);
     }
-    else
+    else if (status == 0)
     {
         // 单独模式
         for (int f = 0; f < fileCount; f++)
         {
-            char *base = basename(files[f].filepath);
-            generate_header(outDir, base, files[f].macro, files[f].symbols, files[f].symbolCount);
+            char *base = basename(files[f].inputPath);
+            generate_header(outDir, base, &files[f], &opts);
             free(base);
         }
     }
@@ -935,10 +7256,14 @@ int main(int argc, char **argv)
     for (int f = 0; f < fileCount; f++)
     {
         free(files[f].filepath);
+        free(files[f].inputPath);
         free(files[f].macro);
         free_symbols(files[f].symbols, files[f].symbolCount);
+        free_assets(files[f].assets, files[f].assetCount);
+        free_sections(files[f].sections, files[f].sectionCount);
     }
     free(files);
+    free(prefixMaps);
 
-    return 0;
+    return status;
 }
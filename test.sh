@@ -1,2 +1,19 @@
 ./SymbolGenerator.run -d ./test -n shader_symbol_test ./test/shaders/linux/default.frag.o DEFAULT_FRAG ./test/shaders/linux/default.vert.o DEFAULT_VERT
 ./SymbolGenerator.run -d ./test -n shader_symbol_test ./test/shaders/windows/default.frag.o DEFAULT_FRAG ./test/shaders/windows/default.vert.o DEFAULT_VERT
+
+# 去重 + 分片：重复资源的分片引用另一个分片中的规范符号，每个分片头文件都必须能单独编译
+mkdir -p ./test/shards
+printf 'shard dedup payload' > ./test/shards/first.bin
+cp ./test/shards/first.bin ./test/shards/second.bin
+./SymbolGenerator.run -d ./test/shards -n shard_test --dedup --prefetch --hot SECOND --shard-by=count:1 ./test/shards/first.bin FIRST ./test/shards/second.bin SECOND || exit 1
+for header in ./test/shards/shard_test*.h; do
+    echo "#include \"$header\"" | gcc -std=c11 -Wall -Werror -fsyntax-only -x c - || { echo "Shard header $header does not compile on its own"; exit 1; }
+done
+echo '#include "./test/shards/shard_test.h"
+void warm(void) { shard_test_prefetch_all(); shard_test_preload_hot(); }' | gcc -std=c11 -Wall -Werror -fsyntax-only -x c - || { echo "Umbrella prefetch helpers missing"; exit 1; }
+
+# 畸形 SPIR-V：模块以只有 2 个字的 OpTypePointer 结尾，反射不能越界读取（用 -fsanitize=address 构建时可以检出）
+mkdir -p ./test/malformed
+printf '\x03\x02\x23\x07\x00\x00\x01\x00\x00\x00\x00\x00\x0a\x00\x00\x00\x00\x00\x00\x00\x47\x00\x04\x00\x02\x00\x00\x00\x21\x00\x00\x00\x00\x00\x00\x00\x3b\x00\x04\x00\x01\x00\x00\x00\x02\x00\x00\x00\x00\x00\x00\x00\x20\x00\x02\x00\x01\x00\x00\x00' > ./test/malformed/bad.spv
+./SymbolGenerator.run -d ./test/malformed -n malformed --spirv --reflect ./test/malformed/bad.spv BAD || { echo "Malformed SPIR-V module was not handled"; exit 1; }
+echo '#include "./test/malformed/malformed.h"' | gcc -std=c11 -Wall -Werror -fsyntax-only -x c - || { echo "Header for malformed SPIR-V does not compile"; exit 1; }